@@ -22,8 +22,34 @@
  * in orientation, body configuration, and subsequent signal emissions.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "Automaton.hpp"
 
+// Particle with its index in world order.
+struct ParticleIndex
+{
+   Particle *particle;
+   int      index;
+};
+
+// Particle index comparison by particle pointer for sorting.
+static int compareParticles(const void *entry1, const void *entry2)
+{
+   Particle *p1 = ((ParticleIndex *)entry1)->particle;
+   Particle *p2 = ((ParticleIndex *)entry2)->particle;
+
+   if (p1 < p2)
+   {
+      return(-1);
+   }
+   if (p1 > p2)
+   {
+      return(1);
+   }
+   return(0);
+}
+
 // Constructor.
 Automaton::Automaton()
 {
@@ -42,6 +68,8 @@ Automaton::Automaton()
    // Initialize morphogen.
    ScopeFactory::reset();
    morphogen.init(&mechanics);
+
+   trajectory = NULL;
 }
 
 
@@ -74,7 +102,7 @@ void Automaton::morph()
          y = (int)particle->vPosition.y;
          if ((x >= 0) && (x < WIDTH) && (y >= 0) && (y < HEIGHT))
          {
-            cells[x][y].particles.push_front(particle);
+            cells[x][y].addParticle(particle);
          }
       }
    }
@@ -103,7 +131,11 @@ void Automaton::morph()
             y2           = y + emission->dy;
             if ((x2 >= 0) && (x2 < WIDTH) && (y2 >= 0) && (y2 < HEIGHT))
             {
+#if (COALESCE_EMISSIONS == 1)
+               cells[x2][y2].coalesce(emission);
+#else
                cells[x2][y2].absorb(emission);
+#endif
             }
             else
             {
@@ -133,6 +165,333 @@ void Automaton::morph()
          cells[x][y].reset();
       }
    }
+
+   // Record trajectory.
+   if (trajectory != NULL)
+   {
+      trajectory->record(&mechanics);
+   }
+}
+
+
+// Take snapshot of world.
+Snapshot *Automaton::snapshot()
+{
+   Snapshot *snapshot = new Snapshot(&mechanics);
+
+   assert(snapshot != NULL);
+   return(snapshot);
+}
+
+
+// Restore world from snapshot into empty automaton.
+void Automaton::restore(Snapshot *snapshot)
+{
+   snapshot->restore(&mechanics);
+}
+
+
+// Save state after a morph in binary form: the world (with its
+// random numbers), absorbed emissions and morphogen state.
+// Signal parameters that are particles are saved as their index in
+// world order; a particle no longer in the world is saved as none.
+// Returns false if not written.
+bool Automaton::saveState(FILE *fp)
+{
+   int            i, j, x, y, numParticles, numEmissions;
+   long           value;
+   Body           *body;
+   Particle       *particle;
+   Emission       *emission;
+   Signal         *signal;
+   Snapshot       *world;
+   ParticleIndex  *particleIndex, key, *entry;
+   StateHeader    header;
+   EmissionRecord record;
+   bool           written;
+
+   // The magic is not null terminated.
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, STATE_MAGIC, sizeof(header.magic));
+   header.version = STATE_VERSION;
+   header.width   = WIDTH;
+   header.height  = HEIGHT;
+   if (fwrite(&header, sizeof(header), 1, fp) != 1)
+   {
+      return(false);
+   }
+
+   // Save world.
+   world   = snapshot();
+   written = world->write(fp);
+   delete world;
+   if (!written)
+   {
+      return(false);
+   }
+
+   // Index particles by pointer.
+   numParticles = 0;
+   for (body = mechanics.bodies; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next)
+      {
+         numParticles++;
+      }
+   }
+   particleIndex = new ParticleIndex[numParticles + 1];
+   assert(particleIndex != NULL);
+   i = 0;
+   for (body = mechanics.bodies; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, i++)
+      {
+         particleIndex[i].particle = particle;
+         particleIndex[i].index    = i;
+      }
+   }
+   qsort(particleIndex, numParticles, sizeof(ParticleIndex), compareParticles);
+
+   // Save absorbed emissions in cell and list order.
+   numEmissions = 0;
+   for (x = 0; x < WIDTH; x++)
+   {
+      for (y = 0; y < HEIGHT; y++)
+      {
+         for (emission = cells[x][y].absorption; emission != NULL;
+              emission = emission->next)
+         {
+            numEmissions++;
+         }
+      }
+   }
+   written = (fwrite(&numEmissions, sizeof(numEmissions), 1, fp) == 1);
+   for (x = 0; written && x < WIDTH; x++)
+   {
+      for (y = 0; written && y < HEIGHT; y++)
+      {
+         for (emission = cells[x][y].absorption;
+              written && emission != NULL; emission = emission->next)
+         {
+            signal = emission->signal;
+            memset(&record, 0, sizeof(record));
+            record.x            = x;
+            record.y            = y;
+            record.dx           = emission->dx;
+            record.dy           = emission->dy;
+            record.delay        = emission->delay;
+            record.duration     = emission->duration;
+            record.multiplicity = emission->multiplicity;
+            if (signal != NULL)
+            {
+               assert((signal->parameters == NULL) || (signal->size > 0));
+               record.hasSignal     = 1;
+               record.strength      = signal->strength;
+               record.numParameters = signal->numParameters;
+               record.typeSize      = signal->type->size;
+               record.size          = signal->size;
+               record.particleMask  = signal->particleMask;
+            }
+            if (fwrite(&record, sizeof(record), 1, fp) != 1)
+            {
+               written = false;
+               break;
+            }
+            if (signal == NULL)
+            {
+               continue;
+            }
+            if (fwrite(signal->type->value, sizeof(int), signal->type->size, fp) !=
+                (size_t)signal->type->size)
+            {
+               written = false;
+               break;
+            }
+            for (j = 0; written && j < signal->size; j++)
+            {
+               if ((signal->particleMask & (1 << j)) != 0)
+               {
+                  key.particle = (Particle *)signal->parameters[j];
+                  entry        = (ParticleIndex *)bsearch(&key, particleIndex,
+                                                          numParticles, sizeof(ParticleIndex),
+                                                          compareParticles);
+                  if (entry != NULL)
+                  {
+                     value = entry->index;
+                  }
+                  else
+                  {
+                     value = -1;
+                  }
+               }
+               else
+               {
+                  value = (long)signal->parameters[j];
+               }
+               written = (fwrite(&value, sizeof(value), 1, fp) == 1);
+            }
+         }
+      }
+   }
+   delete [] particleIndex;
+   if (!written)
+   {
+      return(false);
+   }
+
+   // Save morphogen state.
+   return(morphogen.saveState(fp));
+}
+
+
+// Load state saved after a morph into new automaton
+// (false if unreadable).
+bool Automaton::loadState(FILE *fp)
+{
+   int            i, j, numParticles, numEmissions;
+   int            *typeValues;
+   long           value;
+   bool           valid;
+   void           **parameters;
+   Body           *body;
+   Particle       *particle, **particleList;
+   Emission       *emission, *lastEmission[WIDTH][HEIGHT];
+   Signal         *signal;
+   Snapshot       *world;
+   StateHeader    header;
+   EmissionRecord record;
+
+   if ((fread(&header, sizeof(header), 1, fp) != 1) ||
+       (strncmp(header.magic, STATE_MAGIC, sizeof(header.magic)) != 0) ||
+       (header.version != STATE_VERSION) ||
+       (header.width != WIDTH) || (header.height != HEIGHT))
+   {
+      return(false);
+   }
+
+   // Load world.
+   if ((world = Snapshot::read(fp)) == NULL)
+   {
+      return(false);
+   }
+   restore(world);
+   delete world;
+
+   // List particles in world order.
+   numParticles = 0;
+   for (body = mechanics.bodies; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next)
+      {
+         numParticles++;
+      }
+   }
+   particleList = new Particle *[numParticles + 1];
+   assert(particleList != NULL);
+   i = 0;
+   for (body = mechanics.bodies; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, i++)
+      {
+         particleList[i] = particle;
+      }
+   }
+
+   // Load absorbed emissions, appending to cell lists in order.
+   for (i = 0; i < WIDTH; i++)
+   {
+      for (j = 0; j < HEIGHT; j++)
+      {
+         lastEmission[i][j] = NULL;
+      }
+   }
+   valid = (fread(&numEmissions, sizeof(numEmissions), 1, fp) == 1) &&
+           (numEmissions >= 0);
+   for (i = 0; valid && i < numEmissions; i++)
+   {
+      if ((fread(&record, sizeof(record), 1, fp) != 1) ||
+          (record.x < 0) || (record.x >= WIDTH) ||
+          (record.y < 0) || (record.y >= HEIGHT) ||
+          (record.typeSize < 0) || (record.size < 0) ||
+          (record.size > (int)(sizeof(record.particleMask) * 8)))
+      {
+         valid = false;
+         break;
+      }
+      signal = NULL;
+      if (record.hasSignal == 1)
+      {
+         typeValues = new int[record.typeSize + 1];
+         assert(typeValues != NULL);
+         parameters = NULL;
+         if (record.size > 0)
+         {
+            parameters = new void *[record.size];
+            assert(parameters != NULL);
+         }
+         if (fread(typeValues, sizeof(int), record.typeSize, fp) !=
+             (size_t)record.typeSize)
+         {
+            valid = false;
+         }
+         for (j = 0; valid && j < record.size; j++)
+         {
+            if (fread(&value, sizeof(value), 1, fp) != 1)
+            {
+               valid = false;
+            }
+            else if ((record.particleMask & (1 << j)) != 0)
+            {
+               if ((value < -1) || (value >= numParticles))
+               {
+                  valid = false;
+               }
+               else if (value == -1)
+               {
+                  parameters[j] = NULL;
+               }
+               else
+               {
+                  parameters[j] = (void *)particleList[value];
+               }
+            }
+            else
+            {
+               parameters[j] = (void *)value;
+            }
+         }
+         signal = new Signal(new Compound(typeValues, record.typeSize),
+                             parameters, record.numParameters, record.strength);
+         assert(signal != NULL);
+         signal->setLayout(record.size, record.particleMask);
+         delete [] typeValues;
+      }
+      emission = new Emission(signal, record.dx, record.dy,
+                              record.delay, record.duration);
+      assert(emission != NULL);
+      emission->multiplicity = record.multiplicity;
+      if (lastEmission[record.x][record.y] == NULL)
+      {
+         cells[record.x][record.y].absorption = emission;
+      }
+      else
+      {
+         lastEmission[record.x][record.y]->next = emission;
+      }
+      lastEmission[record.x][record.y] = emission;
+   }
+   delete [] particleList;
+   if (!valid)
+   {
+      return(false);
+   }
+
+   // Load morphogen state.
+   return(morphogen.loadState(fp));
 }
 
 
@@ -28,8 +28,14 @@
 #include "Parameters.h"
 #include "Cell.hpp"
 #include "Mechanics.hpp"
+#include "Snapshot.hpp"
+#include "Trajectory.hpp"
 #include MORPHOGEN_INCLUDE
 
+// Saved state format.
+#define STATE_MAGIC      "MAXSTATE"
+#define STATE_VERSION    1
+
 class Automaton
 {
 public:
@@ -43,13 +49,60 @@ public:
    // Bodies.
    Mechanics mechanics;
 
+   // Trajectory recorded after each morph (NULL if none).
+   Trajectory *trajectory;
+
    // Constructor.
    Automaton();
 
    // Morph.
    void morph();
 
+   // Take snapshot of world.
+   Snapshot *snapshot();
+
+   // Restore world from snapshot into empty automaton.
+   void restore(Snapshot *snapshot);
+
+   // Save state after a morph in binary form: the world (with its
+   // random numbers), absorbed emissions and morphogen state
+   // (false if not written).
+   bool saveState(FILE *fp);
+
+   // Load state saved after a morph into new automaton
+   // (false if unreadable).
+   bool loadState(FILE *fp);
+
    // Get cell at location.
    Cell *getCell(int x, int y);
+
+private:
+
+   // State header.
+   struct StateHeader
+   {
+      char magic[8];
+      int  version;
+      int  width;
+      int  height;
+   };
+
+   // Absorbed emission record: followed by signal type values and
+   // parameters, particle parameters as world particle indices
+   // (-1 = none).
+   struct EmissionRecord
+   {
+      int    x, y;
+      int    dx, dy;
+      int    delay;
+      int    duration;
+      int    multiplicity;
+      int    hasSignal;
+      double strength;
+      int    numParameters;
+      int    typeSize;
+      int    size;
+      int    particleMask;
+   };
 };
 #endif
@@ -21,11 +21,58 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "Body.hpp"
 #include "Physics.h"
 #include "Particle.hpp"
+#include "Bond.hpp"
 #include "Mechanics.hpp"
 
+// Particle index comparison for sorting.
+static int compareIndices(const void *index1, const void *index2)
+{
+   return(*(int *)index1 - *(int *)index2);
+}
+
+
+// Bytes remaining in file (-1 if it cannot be sized).
+static long remaining(FILE *fp)
+{
+   long position, end;
+
+   if (((position = ftell(fp)) == -1) || (fseek(fp, 0, SEEK_END) != 0))
+   {
+      return(-1);
+   }
+   end = ftell(fp);
+   if (fseek(fp, position, SEEK_SET) != 0)
+   {
+      return(0);
+   }
+   return(end - position);
+}
+
+
+// Bond pointer comparison for sorting.
+static int compareBonds(const void *bond1, const void *bond2)
+{
+   Bond *b1 = *(Bond **)bond1;
+   Bond *b2 = *(Bond **)bond2;
+
+   if (b1 < b2)
+   {
+      return(-1);
+   }
+   if (b1 > b2)
+   {
+      return(1);
+   }
+   return(0);
+}
+
+
 // Constructor.
 Body::Body()
 {
@@ -72,7 +119,7 @@ void Body::calcInertia()
 
 
 // Propel body.
-void Body::propel()
+void Body::propel(Random *random)
 {
    Particle *particle;
    Vector3D force, totalForce;
@@ -83,7 +130,7 @@ void Body::propel()
    for (particle = particles; particle != NULL;
         particle = particle->next)
    {
-      particle->propel(force, weight);
+      particle->propel(force, weight, random);
       totalForce  += (force * weight);
       totalWeight += weight;
    }
@@ -95,59 +142,86 @@ void Body::propel()
 
 
 // Duplicate body.
+// Particles are mapped to their copies by index, bonds are copied
+// in particle index order, and mass properties are set once.
 Body *Body::duplicate(Mechanics *mechanics)
 {
-   int      i;
-   Particle *particle, *particle2, *particle3, *particle4;
+   int      i, j, n, numParticles, numLinks, *partners;
+   Particle *particle, *particle2, **copies;
+   Bond     *bond;
 
    Body *body = new Body();
 
    assert(body != NULL);
 
+   // Index particles and count bond links.
+   numParticles = numLinks = 0;
+   for (particle = particles; particle != NULL;
+        particle = particle->next, numParticles++)
+   {
+      particle->mark = numParticles;
+      for (bond = particle->bonds; bond != NULL; numLinks++)
+      {
+         bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+      }
+   }
+
    // Duplicate particles.
+   copies = new Particle *[numParticles + 1];
+   assert(copies != NULL);
    for (particle = particles, i = 0; particle != NULL;
         particle = particle->next, i++)
    {
       particle2        = particle->duplicate();
       particle2->body  = body;
       particle2->bonds = NULL;
-      particle->mark   = particle2->mark = i;
-      mechanics->addParticle(body, particle2, vVelocity);
+      particle2->next  = body->particles;
+      body->particles  = particle2;
+      body->fMass     += particle2->fMass;
+      if (particle2->fixed)
+      {
+         body->fixedCount++;
+      }
+      copies[i] = particle2;
+   }
+   mechanics->numParticles += numParticles;
+   body->calcInertia();
+   if ((numParticles > 0) && (body->fixedCount == 0))
+   {
+      body->vVelocity = vVelocity;
    }
 
-   // Duplicate bonds.
-   for (particle = particles; particle != NULL;
-        particle = particle->next)
+   // Duplicate bonds to higher indexed particles in index order.
+   partners = new int[numLinks + 1];
+   assert(partners != NULL);
+   for (particle = particles, i = 0; particle != NULL;
+        particle = particle->next, i++)
    {
-      for (particle2 = particles; particle2 != NULL;
-           particle2 = particle2->next)
+      for (bond = particle->bonds, n = 0; bond != NULL; )
       {
-         if (particle == particle2)
+         if (bond->particle1 == particle)
          {
-            continue;
+            particle2 = bond->particle2;
+            bond      = bond->next1;
          }
-         if (particle->getBond(particle2) != NULL)
+         else
+         {
+            particle2 = bond->particle1;
+            bond      = bond->next2;
+         }
+         if (particle2->mark > i)
          {
-            for (particle3 = body->particles; particle3 != NULL;
-                 particle3 = particle3->next)
-            {
-               if (particle3->mark == particle->mark)
-               {
-                  break;
-               }
-            }
-            for (particle4 = body->particles; particle4 != NULL;
-                 particle4 = particle4->next)
-            {
-               if (particle4->mark == particle2->mark)
-               {
-                  break;
-               }
-            }
-            mechanics->createBond(particle3, particle4);
+            partners[n++] = particle2->mark;
          }
       }
+      qsort(partners, n, sizeof(int), compareIndices);
+      for (j = 0; j < n; j++)
+      {
+         mechanics->createBond(copies[i], copies[partners[j]]);
+      }
    }
+   delete [] partners;
+   delete [] copies;
    return(body);
 }
 
@@ -263,3 +337,366 @@ void Body::write(FILE *fp, Body *body)
    }
    fflush(fp);
 }
+
+
+// Read body in binary form.
+// Particles and bond lists are restored in their written order, so
+// a body reads back exactly as written.
+// Return NULL if body records are invalid.
+Body *Body::readBinary(FILE *fp, Mechanics *mechanics)
+{
+   int            i, j, k, numLinks, *bondLinks, *bondEnds;
+   BodyRecord     bodyRecord;
+   ParticleRecord *particleRecords, *particleRecord;
+   BondRecord     *bondRecords;
+   Particle       *particle, **particleList;
+   Bond           *bond, *lastBond, **bondList;
+   bool           valid;
+   long           size;
+
+   if ((fread(&bodyRecord, sizeof(bodyRecord), 1, fp) != 1) ||
+       (bodyRecord.numParticles < 0) || (bodyRecord.numBonds < 0) ||
+       (bodyRecord.numBonds > INT_MAX / 2 - 1))
+   {
+      return(NULL);
+   }
+
+   // Records must fit in the rest of the file (when it can be sized),
+   // so that a damaged count does not make a huge allocation.
+   size = remaining(fp);
+   if ((size != -1) &&
+       ((double)size <
+        (double)bodyRecord.numParticles * sizeof(ParticleRecord) +
+        (double)bodyRecord.numBonds * (sizeof(BondRecord) + 2 * sizeof(int))))
+   {
+      return(NULL);
+   }
+
+   // Read and check records before building body.
+   numLinks        = bodyRecord.numBonds * 2;
+   particleRecords = new ParticleRecord[bodyRecord.numParticles + 1];
+   assert(particleRecords != NULL);
+   bondRecords = new BondRecord[bodyRecord.numBonds + 1];
+   assert(bondRecords != NULL);
+   bondLinks = new int[numLinks + 1];
+   assert(bondLinks != NULL);
+   bondEnds = new int[bodyRecord.numBonds + 1];
+   assert(bondEnds != NULL);
+   valid = (((int)fread(particleRecords, sizeof(ParticleRecord),
+                        bodyRecord.numParticles, fp) == bodyRecord.numParticles) &&
+            ((int)fread(bondRecords, sizeof(BondRecord),
+                        bodyRecord.numBonds, fp) == bodyRecord.numBonds) &&
+            ((int)fread(bondLinks, sizeof(int), numLinks, fp) == numLinks));
+   for (j = 0; valid && j < bodyRecord.numParticles; j++)
+   {
+      if ((particleRecords[j].direction < NORTH) ||
+          (particleRecords[j].direction > NORTHWEST))
+      {
+         valid = false;
+      }
+   }
+   for (i = 0; valid && i < bodyRecord.numBonds; i++)
+   {
+      bondEnds[i] = 0;
+      if ((bondRecords[i].particle1 < 0) ||
+          (bondRecords[i].particle1 >= bodyRecord.numParticles) ||
+          (bondRecords[i].particle2 < 0) ||
+          (bondRecords[i].particle2 >= bodyRecord.numParticles) ||
+          (bondRecords[i].particle1 == bondRecords[i].particle2))
+      {
+         valid = false;
+      }
+   }
+
+   // Each bond must be linked once from each of its particles.
+   for (j = k = 0; valid && j < bodyRecord.numParticles; j++)
+   {
+      if ((particleRecords[j].numBonds < 0) ||
+          (particleRecords[j].numBonds > numLinks - k))
+      {
+         valid = false;
+         break;
+      }
+      for (i = 0; i < particleRecords[j].numBonds; i++, k++)
+      {
+         if ((bondLinks[k] < 0) || (bondLinks[k] >= bodyRecord.numBonds))
+         {
+            valid = false;
+         }
+         else if ((bondRecords[bondLinks[k]].particle1 == j) &&
+                  ((bondEnds[bondLinks[k]] & 1) == 0))
+         {
+            bondEnds[bondLinks[k]] |= 1;
+         }
+         else if ((bondRecords[bondLinks[k]].particle2 == j) &&
+                  ((bondEnds[bondLinks[k]] & 2) == 0))
+         {
+            bondEnds[bondLinks[k]] |= 2;
+         }
+         else
+         {
+            valid = false;
+         }
+      }
+   }
+   if (valid && (k != numLinks))
+   {
+      valid = false;
+   }
+   delete [] bondEnds;
+   if (!valid)
+   {
+      delete [] particleRecords;
+      delete [] bondRecords;
+      delete [] bondLinks;
+      return(NULL);
+   }
+
+   Body *body = new Body();
+   assert(body != NULL);
+   body->vVelocity.x = bodyRecord.velocity[0];
+   body->vVelocity.y = bodyRecord.velocity[1];
+   body->vVelocity.z = bodyRecord.velocity[2];
+
+   // Create particles: adding prepends, so add in reverse order.
+   particleList = new Particle *[bodyRecord.numParticles + 1];
+   assert(particleList != NULL);
+   for (j = bodyRecord.numParticles - 1; j >= 0; j--)
+   {
+      particleRecord = &particleRecords[j];
+      particle       = new Particle(0);
+      assert(particle != NULL);
+      particle->type    = particleRecord->type;
+      particle->fRadius = particleRecord->radius;
+      particle->fMass   = particleRecord->mass;
+      particle->fCharge = particleRecord->charge;
+      particle->coefficientOfRestitution = particleRecord->restitution;
+      particle->orientation.direction    = particleRecord->direction;
+      particle->orientation.mirrored     = (particleRecord->mirrored == 1);
+      particle->vPosition.x = particleRecord->position[0];
+      particle->vPosition.y = particleRecord->position[1];
+      particle->vPosition.z = particleRecord->position[2];
+      particle->fixed       = (particleRecord->fixed == 1);
+      particle->mark        = particleRecord->mark;
+      mechanics->addParticle(body, particle, body->vVelocity);
+      particleList[j] = particle;
+   }
+
+   // Create bonds.
+   bondList = new Bond *[bodyRecord.numBonds + 1];
+   assert(bondList != NULL);
+   for (i = 0; i < bodyRecord.numBonds; i++)
+   {
+      bond = new Bond(particleList[bondRecords[i].particle1],
+                      particleList[bondRecords[i].particle2]);
+      assert(bond != NULL);
+      bondList[i] = bond;
+   }
+
+   // Restore particle bond lists in order.
+   for (j = k = 0; j < bodyRecord.numParticles; j++)
+   {
+      particle = particleList[j];
+      lastBond = NULL;
+      for (i = 0; i < particleRecords[j].numBonds; i++, k++)
+      {
+         bond = bondList[bondLinks[k]];
+         if (lastBond == NULL)
+         {
+            particle->bonds = bond;
+         }
+         else if (lastBond->particle1 == particle)
+         {
+            lastBond->next1 = bond;
+         }
+         else
+         {
+            lastBond->next2 = bond;
+         }
+         lastBond = bond;
+      }
+   }
+   if (bodyRecord.numBonds > 0)
+   {
+      mechanics->revision++;
+   }
+   delete [] bondList;
+   delete [] particleList;
+   delete [] particleRecords;
+   delete [] bondRecords;
+   delete [] bondLinks;
+   return(body);
+}
+
+
+// Write body in binary form (false if not written).
+bool Body::writeBinary(FILE *fp, Body *body)
+{
+   int            i, j, k, n, numParticles, numLinks, numBonds;
+   int            *bondOrder, *bondLinks;
+   Particle       *particle;
+   Bond           *bond, **bondList, **entry;
+   BodyRecord     bodyRecord;
+   ParticleRecord *particleRecords, *particleRecord;
+   BondRecord     *bondRecords;
+   bool           written;
+
+   // Count particles and bond links.
+   numParticles = numLinks = 0;
+   for (particle = body->particles; particle != NULL;
+        particle = particle->next)
+   {
+      numParticles++;
+      for (bond = particle->bonds; bond != NULL; numLinks++)
+      {
+         bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+      }
+   }
+
+   // Record particles, marking them with their record indices.
+   particleRecords = new ParticleRecord[numParticles + 1];
+   assert(particleRecords != NULL);
+   bondList = new Bond *[numLinks + 1];
+   assert(bondList != NULL);
+   for (particle = body->particles, j = k = 0; particle != NULL;
+        particle = particle->next, j++)
+   {
+      particleRecord = &particleRecords[j];
+      memset(particleRecord, 0, sizeof(ParticleRecord));
+      particleRecord->type        = particle->type;
+      particleRecord->radius      = particle->fRadius;
+      particleRecord->mass        = particle->fMass;
+      particleRecord->charge      = particle->fCharge;
+      particleRecord->restitution = particle->coefficientOfRestitution;
+      particleRecord->direction   = particle->orientation.direction;
+      particleRecord->mirrored    = particle->orientation.mirrored ? 1 : 0;
+      particleRecord->position[0] = particle->vPosition.x;
+      particleRecord->position[1] = particle->vPosition.y;
+      particleRecord->position[2] = particle->vPosition.z;
+      particleRecord->fixed       = particle->fixed ? 1 : 0;
+      particleRecord->mark        = particle->mark;
+      particle->mark = j;
+      for (bond = particle->bonds; bond != NULL; k++)
+      {
+         bondList[k] = bond;
+         particleRecord->numBonds++;
+         bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+      }
+   }
+
+   // Sort and unique bond list.
+   qsort(bondList, numLinks, sizeof(Bond *), compareBonds);
+   for (i = numBonds = 0; i < numLinks; i++)
+   {
+      if ((numBonds == 0) || (bondList[i] != bondList[numBonds - 1]))
+      {
+         bondList[numBonds] = bondList[i];
+         numBonds++;
+      }
+   }
+
+   // Number bonds in order of first link, and convert bond
+   // links to bond record indices.
+   bondRecords = new BondRecord[numBonds + 1];
+   assert(bondRecords != NULL);
+   bondOrder = new int[numBonds + 1];
+   assert(bondOrder != NULL);
+   bondLinks = new int[numLinks + 1];
+   assert(bondLinks != NULL);
+   for (i = 0; i < numBonds; i++)
+   {
+      bondOrder[i] = -1;
+   }
+   for (particle = body->particles, i = k = 0; particle != NULL;
+        particle = particle->next)
+   {
+      for (bond = particle->bonds; bond != NULL; k++)
+      {
+         entry = (Bond **)bsearch(&bond, bondList, numBonds, sizeof(Bond *),
+                                  compareBonds);
+         assert(entry != NULL);
+         n = (int)(entry - bondList);
+         if (bondOrder[n] == -1)
+         {
+            bondOrder[n] = i;
+            bondRecords[i].particle1 = bond->particle1->mark;
+            bondRecords[i].particle2 = bond->particle2->mark;
+            i++;
+         }
+         bondLinks[k] = bondOrder[n];
+         bond         = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+      }
+   }
+
+   // Restore marks.
+   for (particle = body->particles, j = 0; particle != NULL;
+        particle = particle->next, j++)
+   {
+      particle->mark = particleRecords[j].mark;
+   }
+
+   memset(&bodyRecord, 0, sizeof(bodyRecord));
+   bodyRecord.velocity[0]  = body->vVelocity.x;
+   bodyRecord.velocity[1]  = body->vVelocity.y;
+   bodyRecord.velocity[2]  = body->vVelocity.z;
+   bodyRecord.numParticles = numParticles;
+   bodyRecord.numBonds     = numBonds;
+   written = ((fwrite(&bodyRecord, sizeof(bodyRecord), 1, fp) == 1) &&
+              ((int)fwrite(particleRecords, sizeof(ParticleRecord),
+                           numParticles, fp) == numParticles) &&
+              ((int)fwrite(bondRecords, sizeof(BondRecord),
+                           numBonds, fp) == numBonds) &&
+              ((int)fwrite(bondLinks, sizeof(int), numLinks, fp) == numLinks) &&
+              (fflush(fp) == 0));
+
+   delete [] bondLinks;
+   delete [] bondOrder;
+   delete [] bondRecords;
+   delete [] bondList;
+   delete [] particleRecords;
+   return(written);
+}
+
+
+// Read binary body file header.
+// A header with an unknown version, or with more bodies than the rest of
+// the file can hold, gives an invalid number of bodies.
+bool Body::readHeader(FILE *fp, int& numBodies)
+{
+   long       position, size;
+   FileHeader header;
+
+   position = ftell(fp);
+   if ((fread(&header, sizeof(header), 1, fp) != 1) ||
+       (strncmp(header.magic, BODY_MAGIC, sizeof(header.magic)) != 0))
+   {
+      fseek(fp, position, SEEK_SET);
+      return(false);
+   }
+   // Each body takes at least a body record.
+   size = remaining(fp);
+   if ((header.version == BODY_VERSION) &&
+       ((size == -1) ||
+        ((double)header.numBodies * sizeof(BodyRecord) <= (double)size)))
+   {
+      numBodies = header.numBodies;
+   }
+   else
+   {
+      numBodies = -1;
+   }
+   return(true);
+}
+
+
+// Write binary body file header (false if not written).
+bool Body::writeHeader(FILE *fp, int numBodies)
+{
+   FileHeader header;
+
+   memset(&header, 0, sizeof(header));
+   strncpy(header.magic, BODY_MAGIC, sizeof(header.magic));
+   header.version   = BODY_VERSION;
+   header.numBodies = numBodies;
+   return(fwrite(&header, sizeof(header), 1, fp) == 1);
+}
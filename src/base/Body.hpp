@@ -29,6 +29,14 @@
 
 class Particle;
 class Mechanics;
+class Random;
+
+// Binary body file: a header giving the number of bodies, followed by
+// each body's particle records in list order, its bond table, and each
+// particle's bond links as bond table indices.
+#define BINARY_BODIES    1
+#define BODY_MAGIC       "MAXBODY"
+#define BODY_VERSION     1
 
 class Body
 {
@@ -57,7 +65,7 @@ public:
    void calcInertia();
 
    // Propel body.
-   void propel();
+   void propel(Random *random);
 
    // Duplicate body.
    Body *duplicate(Mechanics *);
@@ -65,5 +73,55 @@ public:
    // Read and write body.
    static Body *read(FILE *fp, Mechanics *);
    static void write(FILE *fp, Body *body);
+
+   // Read and write body in binary form (read returns NULL if invalid).
+   static Body *readBinary(FILE *fp, Mechanics *);
+   // Write returns false if not written.
+   static bool writeBinary(FILE *fp, Body *body);
+
+   // Read binary body file header: false if file is not binary,
+   // in which case the file position is restored.
+   static bool readHeader(FILE *fp, int& numBodies);
+
+   // Write binary body file header (false if not written).
+   static bool writeHeader(FILE *fp, int numBodies);
+
+private:
+
+   // Binary file header.
+   struct FileHeader
+   {
+      char magic[8];
+      int  version;
+      int  numBodies;
+   };
+
+   // Binary body, particle and bond records.
+   // Bond links are written after the bond table in particle order.
+   struct BodyRecord
+   {
+      float velocity[3];
+      int   numParticles;
+      int   numBonds;
+   };
+   struct ParticleRecord
+   {
+      int   type;
+      float radius;
+      float mass;
+      float charge;
+      float restitution;
+      int   direction;
+      int   mirrored;
+      float position[3];
+      int   fixed;
+      int   mark;
+      int   numBonds;
+   };
+   struct BondRecord
+   {
+      int particle1;
+      int particle2;
+   };
 };
 #endif
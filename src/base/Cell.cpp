@@ -24,6 +24,7 @@
 Cell::Cell()
 {
    x          = y = 0;
+   typeMask   = 0;
    absorption = NULL;
 }
 
@@ -42,6 +43,14 @@ Cell::~Cell()
 }
 
 
+// Add particle to cell.
+void Cell::addParticle(Particle *particle)
+{
+   particles.push_front(particle);
+   typeMask |= (OCCUPIED_MASK | TYPE_MASK(particle->type));
+}
+
+
 // Absorb signal emission.
 void Cell::absorb(Emission *emission)
 {
@@ -50,6 +59,34 @@ void Cell::absorb(Emission *emission)
 }
 
 
+// Absorb signal emission, coalescing it into an identical
+// absorbed emission if possible: an emission having the same signal
+// payload, strength and timing adds its multiplicity to the existing one.
+void Cell::coalesce(Emission *emission)
+{
+   Emission *emission2;
+
+   if ((emission->signal != NULL) && (emission->signal->numParameters > 0))
+   {
+      for (emission2 = absorption; emission2 != NULL;
+           emission2 = emission2->next)
+      {
+         if ((emission2->signal != NULL) &&
+             (emission2->delay == emission->delay) &&
+             (emission2->duration == emission->duration) &&
+             (emission2->signal->strength == emission->signal->strength) &&
+             emission2->signal->equals(emission->signal))
+         {
+            emission2->multiplicity += emission->multiplicity;
+            delete emission;
+            return;
+         }
+      }
+   }
+   absorb(emission);
+}
+
+
 // Reset: age absorbed emissions and detach particles.
 void Cell::reset()
 {
@@ -82,9 +119,212 @@ void Cell::reset()
    }
    absorption = newAbsorption;
    particles.clear();
+   typeMask = 0;
 }
 
 
+// Neighborhood cell location table.
+const int Neighborhood::cellLocations[NUM_ORIENTATIONS][3][3][2] =
+{
+   // Direction 0.
+   {
+      { { -1, -1 }, { -1,  0 }, { -1,  1 } },
+      { {  0, -1 }, {  0,  0 }, {  0,  1 } },
+      { {  1, -1 }, {  1,  0 }, {  1,  1 } }
+   },
+   // Direction 1.
+   {
+      { { -1,  0 }, { -1,  1 }, {  0,  1 } },
+      { { -1, -1 }, {  0,  0 }, {  1,  1 } },
+      { {  0, -1 }, {  1, -1 }, {  1,  0 } }
+   },
+   // Direction 2.
+   {
+      { { -1,  1 }, {  0,  1 }, {  1,  1 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1, -1 }, {  0, -1 }, {  1, -1 } }
+   },
+   // Direction 3.
+   {
+      { {  0,  1 }, {  1,  1 }, {  1,  0 } },
+      { { -1,  1 }, {  0,  0 }, {  1, -1 } },
+      { { -1,  0 }, { -1, -1 }, {  0, -1 } }
+   },
+   // Direction 4.
+   {
+      { {  1,  1 }, {  1,  0 }, {  1, -1 } },
+      { {  0,  1 }, {  0,  0 }, {  0, -1 } },
+      { { -1,  1 }, { -1,  0 }, { -1, -1 } }
+   },
+   // Direction 5.
+   {
+      { {  1,  0 }, {  1, -1 }, {  0, -1 } },
+      { {  1,  1 }, {  0,  0 }, { -1, -1 } },
+      { {  0,  1 }, { -1,  1 }, { -1,  0 } }
+   },
+   // Direction 6.
+   {
+      { {  1, -1 }, {  0, -1 }, { -1, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  1,  1 }, {  0,  1 }, { -1,  1 } }
+   },
+   // Direction 7.
+   {
+      { {  0, -1 }, { -1, -1 }, { -1,  0 } },
+      { {  1, -1 }, {  0,  0 }, { -1,  1 } },
+      { {  1,  0 }, {  1,  1 }, {  0,  1 } }
+   },
+   // Direction 0, mirrored.
+   {
+      { { -1, -1 }, { -1,  0 }, { -1,  1 } },
+      { {  0, -1 }, {  0,  0 }, {  0,  1 } },
+      { {  1, -1 }, {  1,  0 }, {  1,  1 } }
+   },
+   // Direction 1, mirrored.
+   {
+      { {  0, -1 }, { -1, -1 }, { -1,  0 } },
+      { {  1, -1 }, {  0,  0 }, { -1,  1 } },
+      { {  1,  0 }, {  1,  1 }, {  0,  1 } }
+   },
+   // Direction 2, mirrored.
+   {
+      { {  1, -1 }, {  0, -1 }, { -1, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  1,  1 }, {  0,  1 }, { -1,  1 } }
+   },
+   // Direction 3, mirrored.
+   {
+      { {  1,  0 }, {  1, -1 }, {  0, -1 } },
+      { {  1,  1 }, {  0,  0 }, { -1, -1 } },
+      { {  0,  1 }, { -1,  1 }, { -1,  0 } }
+   },
+   // Direction 4, mirrored.
+   {
+      { {  1,  1 }, {  1,  0 }, {  1, -1 } },
+      { {  0,  1 }, {  0,  0 }, {  0, -1 } },
+      { { -1,  1 }, { -1,  0 }, { -1, -1 } }
+   },
+   // Direction 5, mirrored.
+   {
+      { {  0,  1 }, {  1,  1 }, {  1,  0 } },
+      { { -1,  1 }, {  0,  0 }, {  1, -1 } },
+      { { -1,  0 }, { -1, -1 }, {  0, -1 } }
+   },
+   // Direction 6, mirrored.
+   {
+      { { -1,  1 }, {  0,  1 }, {  1,  1 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1, -1 }, {  0, -1 }, {  1, -1 } }
+   },
+   // Direction 7, mirrored.
+   {
+      { { -1,  0 }, { -1,  1 }, {  0,  1 } },
+      { { -1, -1 }, {  0,  0 }, {  1,  1 } },
+      { {  0, -1 }, {  1, -1 }, {  1,  0 } }
+   }
+};
+
+// Neighborhood cell offset table.
+const int Neighborhood::dxys[NUM_ORIENTATIONS][3][3][2] =
+{
+   // Direction 0.
+   {
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } }
+   },
+   // Direction 1.
+   {
+      { {  0,  1 }, {  0,  1 }, {  1,  0 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1,  0 }, {  0, -1 }, {  0, -1 } }
+   },
+   // Direction 2.
+   {
+      { {  0,  2 }, {  1,  1 }, {  2,  0 } },
+      { { -1,  1 }, {  0,  0 }, {  1, -1 } },
+      { { -2,  0 }, { -1, -1 }, {  0, -2 } }
+   },
+   // Direction 3.
+   {
+      { {  1,  2 }, {  2,  1 }, {  2, -1 } },
+      { { -1,  2 }, {  0,  0 }, {  1, -2 } },
+      { { -2,  1 }, { -2, -1 }, { -1, -2 } }
+   },
+   // Direction 4.
+   {
+      { {  2,  2 }, {  2,  0 }, {  2, -2 } },
+      { {  0,  2 }, {  0,  0 }, {  0, -2 } },
+      { { -2,  2 }, { -2,  0 }, { -2, -2 } }
+   },
+   // Direction 5.
+   {
+      { {  2,  1 }, {  2, -1 }, {  1, -2 } },
+      { {  1,  2 }, {  0,  0 }, { -1, -2 } },
+      { { -1,  2 }, { -2,  1 }, { -2, -1 } }
+   },
+   // Direction 6.
+   {
+      { {  2,  0 }, {  1, -1 }, {  0, -2 } },
+      { {  1,  1 }, {  0,  0 }, { -1, -1 } },
+      { {  0,  2 }, { -1,  1 }, { -2,  0 } }
+   },
+   // Direction 7.
+   {
+      { {  1,  0 }, {  0, -1 }, {  0, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  0,  1 }, {  0,  1 }, { -1,  0 } }
+   },
+   // Direction 0, mirrored.
+   {
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } }
+   },
+   // Direction 1, mirrored.
+   {
+      { {  1,  0 }, {  0, -1 }, {  0, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  0,  1 }, {  0,  1 }, { -1,  0 } }
+   },
+   // Direction 2, mirrored.
+   {
+      { {  2,  0 }, {  1, -1 }, {  0, -2 } },
+      { {  1,  1 }, {  0,  0 }, { -1, -1 } },
+      { {  0,  2 }, { -1,  1 }, { -2,  0 } }
+   },
+   // Direction 3, mirrored.
+   {
+      { {  2,  1 }, {  2, -1 }, {  1, -2 } },
+      { {  1,  2 }, {  0,  0 }, { -1, -2 } },
+      { { -1,  2 }, { -2,  1 }, { -2, -1 } }
+   },
+   // Direction 4, mirrored.
+   {
+      { {  2,  2 }, {  2,  0 }, {  2, -2 } },
+      { {  0,  2 }, {  0,  0 }, {  0, -2 } },
+      { { -2,  2 }, { -2,  0 }, { -2, -2 } }
+   },
+   // Direction 5, mirrored.
+   {
+      { {  1,  2 }, {  2,  1 }, {  2, -1 } },
+      { { -1,  2 }, {  0,  0 }, {  1, -2 } },
+      { { -2,  1 }, { -2, -1 }, { -1, -2 } }
+   },
+   // Direction 6, mirrored.
+   {
+      { {  0,  2 }, {  1,  1 }, {  2,  0 } },
+      { { -1,  1 }, {  0,  0 }, {  1, -1 } },
+      { { -2,  0 }, { -1, -1 }, {  0, -2 } }
+   },
+   // Direction 7, mirrored.
+   {
+      { {  0,  1 }, {  0,  1 }, {  1,  0 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1,  0 }, {  0, -1 }, {  0, -1 } }
+   }
+};
+
 // Neighborhood constructor.
 Neighborhood::Neighborhood()
 {
@@ -107,8 +347,34 @@ void Neighborhood::transform(Orientation& orientation)
 }
 
 
+// Get current transform orientation index.
+int Neighborhood::getOrientationIndex()
+{
+   return(orientation.getIndex());
+}
+
+
 // Get real cell location given input location and current transform state.
 void Neighborhood::getCellLocation(int& x, int& y)
+{
+   const int *location;
+
+   if ((x >= -1) && (x <= 1) && (y >= -1) && (y <= 1) &&
+       (orientation.direction >= 0) && (orientation.direction < 8))
+   {
+      location = cellLocations[orientation.getIndex()][x + 1][y + 1];
+      x        = location[0];
+      y        = location[1];
+   }
+   else
+   {
+      computeCellLocation(x, y);
+   }
+}
+
+
+// Compute real cell location given input location and current transform state.
+void Neighborhood::computeCellLocation(int& x, int& y)
 {
    int x2, y2, xret, yret, dir, r;
 
@@ -403,6 +669,25 @@ void Neighborhood::getCellLocation(int& x, int& y)
 
 // Get offsets to cell clockwise steps from given cell in neighborhood.
 void Neighborhood::getDxy(int x, int y, Orientation steps, int& dx, int& dy)
+{
+   const int *dxy;
+
+   assert(x >= -1 && x <= 1 && y >= -1 && y <= 1);
+   if ((steps.direction >= 0) && (steps.direction < 8))
+   {
+      dxy = dxys[steps.getIndex()][x + 1][y + 1];
+      dx  = dxy[0];
+      dy  = dxy[1];
+   }
+   else
+   {
+      computeDxy(x, y, steps, dx, dy);
+   }
+}
+
+
+// Compute offsets to cell clockwise steps from given cell in neighborhood.
+void Neighborhood::computeDxy(int x, int y, Orientation steps, int& dx, int& dy)
 {
    int dir, dir2;
 
@@ -25,6 +25,14 @@
 #include "Particle.hpp"
 #include <list>
 
+// Cell type mask: a bit for each particle type present
+// and an occupied bit set if any particle is present.
+#define MAX_MASK_TYPES    30
+#define OCCUPIED_MASK     (1u << MAX_MASK_TYPES)
+#define TYPE_MASK(type)                              \
+   ((((type) >= 0) && ((type) < MAX_MASK_TYPES)) ? \
+    (1u << (type)) : 0u)
+
 class Cell
 {
 public:
@@ -35,6 +43,9 @@ public:
    // Cell particles.
    std::list<Particle *> particles;
 
+   // Type mask of cell particles.
+   unsigned int typeMask;
+
    // Absorbed signal emissions.
    Emission *absorption;
 
@@ -44,9 +55,16 @@ public:
    // Cell destructor.
    ~Cell();
 
+   // Add particle to cell.
+   void addParticle(Particle *particle);
+
    // Absorb signal emission.
    void absorb(Emission *emission);
 
+   // Absorb signal emission, coalescing it into an identical
+   // absorbed emission if possible.
+   void coalesce(Emission *emission);
+
    // Reset cell.
    void reset();
 };
@@ -72,12 +90,29 @@ public:
    // Get real cell location given input location and current transform state.
    void getCellLocation(int& x, int& y);
 
+   // Get current transform orientation index.
+   int getOrientationIndex();
+
    // Get offsets to cell clockwise steps from given cell in neighborhood.
    // Given cell location must be in neighborhood: -1 <= x,y <= 1
    static void getDxy(int x, int y, Orientation steps, int& dx, int& dy);
 
+   // Compute real cell location given input location and
+   // current transform state, without the transform tables.
+   void computeCellLocation(int& x, int& y);
+
+   // Compute offsets to cell clockwise steps from given cell,
+   // without the transform tables.
+   static void computeDxy(int x, int y, Orientation steps, int& dx, int& dy);
+
 private:
 
    Orientation orientation;
+
+   // Transform tables for cells within the neighborhood, indexed by
+   // orientation index, x + 1 and y + 1. Generated from the computed
+   // transforms; TestTransforms checks that they still agree.
+   static const int cellLocations[NUM_ORIENTATIONS][3][3][2];
+   static const int dxys[NUM_ORIENTATIONS][3][3][2];
 };
 #endif
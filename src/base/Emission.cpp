@@ -28,6 +28,7 @@ Emission::Emission(Signal *signal, int dx, int dy)
    this->dy     = dy;
    delay        = 0;
    duration     = 1;
+   multiplicity = 1;
    next         = NULL;
 }
 
@@ -39,6 +40,7 @@ Emission::Emission(Signal *signal, int dx, int dy, int delay, int duration)
    this->dy       = dy;
    this->delay    = delay;
    this->duration = duration;
+   multiplicity   = 1;
    next           = NULL;
 }
 
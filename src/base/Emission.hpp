@@ -31,6 +31,7 @@ public:
    int      dx, dy;
    int      delay;
    int      duration;
+   int      multiplicity; // number of coalesced emissions
    Emission *next;
 
    // Constructors.
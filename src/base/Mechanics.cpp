@@ -26,7 +26,9 @@ Mechanics::Mechanics()
 {
    bodies       = NULL;
    numParticles = 0;
+   revision     = 0;
    collisions   = NULL;
+   contacts     = NULL;
 }
 
 
@@ -41,6 +43,7 @@ Mechanics::~Mechanics()
       delete bodies;
       bodies = body;
    }
+   clearContacts();
 }
 
 
@@ -54,6 +57,7 @@ Body *Mechanics::createBody(int type, double radius, double mass, double charge)
    Body     *body     = createBody();
    Particle *particle = new Particle(type, radius, mass, charge);
    addParticle(body, particle);
+   revision++;
    return(body);
 }
 
@@ -76,6 +80,7 @@ void Mechanics::addBody(Body *body)
 {
    body->next = bodies;
    bodies     = body;
+   revision++;
 }
 
 
@@ -104,9 +109,11 @@ void Mechanics::removeBody(Body *body)
    for (particle = body->particles; particle != NULL;
         particle = particle->next)
    {
+      clearContacts(particle);
       numParticles--;
    }
    delete body;
+   revision++;
 }
 
 
@@ -169,6 +176,11 @@ void Mechanics::removeParticle(Body *body, Particle *particle)
    {
       body->fixedCount--;
    }
+   if (particle->type != WALL_TYPE)
+   {
+      clearContacts(particle);
+      revision++;
+   }
    delete particle;
    numParticles--;
    if (body->particles == NULL)
@@ -218,6 +230,7 @@ Bond *Mechanics::createBond(Particle *particle1, Particle *particle2)
    }
    bond = new Bond(particle1, particle2);
    assert(bond != NULL);
+   revision++;
    bond->next1      = particle1->bonds;
    particle1->bonds = bond;
    bond->next2      = particle2->bonds;
@@ -247,6 +260,7 @@ void Mechanics::removeBond(Bond *bond)
    Body *body = bond->particle1->body;
 
    delete bond;
+   revision++;
    if (markParticlePartitions(body) > 1)
    {
       partitionParticles(body);
@@ -418,6 +432,7 @@ void Mechanics::step(double dtime)
                if ((double)dist > Bond::MAX_BOND_LENGTH)
                {
                   bond->disconnect(particle);
+                  revision++;
                   done = false;
                   break;
                }
@@ -443,6 +458,7 @@ void Mechanics::step(double dtime)
    }
 
    // Process collisions and charge forces.
+   clearContacts();
    for (body = bodies; body != NULL; body = body->next)
    {
       body->collide = false;
@@ -487,6 +503,7 @@ void Mechanics::checkCollisions(Body *body1)
    Particle  *particle1, *particle2;
    Vector3D  vnormal, vrelative, vpoint, vposition;
    Collision *collision;
+   Contact   *contact;
 
    if (body1->collide)
    {
@@ -587,6 +604,12 @@ void Mechanics::checkCollisions(Body *body1)
                   collision->particle2        = particle2;
                   particle1->collide          = particle2;
                   particle2->collide          = particle1;
+                  contact = new Contact();
+                  assert(contact != NULL);
+                  contact->particle1 = particle1;
+                  contact->particle2 = particle2;
+                  contact->next      = contacts;
+                  contacts           = contact;
                   collision->vCollisionNormal = vnormal;
                   collision->vCollisionPoint  = (vnormal * particle1->fRadius) +
                                                 particle1->vPosition;
@@ -660,6 +683,39 @@ void Mechanics::resolveCollisions()
 }
 
 
+// Clear contacts.
+void Mechanics::clearContacts()
+{
+   Contact *contact;
+
+   while (contacts != NULL)
+   {
+      contact  = contacts;
+      contacts = contact->next;
+      delete contact;
+   }
+}
+
+
+// Clear removed particle from contacts.
+void Mechanics::clearContacts(Particle *particle)
+{
+   Contact *contact;
+
+   for (contact = contacts; contact != NULL; contact = contact->next)
+   {
+      if (contact->particle1 == particle)
+      {
+         contact->particle1 = NULL;
+      }
+      if (contact->particle2 == particle)
+      {
+         contact->particle2 = NULL;
+      }
+   }
+}
+
+
 // Update charge forces.
 void Mechanics::updateChargeForces(Body *body1)
 {
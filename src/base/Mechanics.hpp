@@ -29,6 +29,7 @@
 #include "Body.hpp"
 #include "Particle.hpp"
 #include "Bond.hpp"
+#include "../util/Random.hpp"
 #ifdef UNIX
 #include MORPHOGEN_INCLUDE
 #endif
@@ -44,6 +45,14 @@ public:
    Body *bodies;
    int  numParticles;
 
+   // Structure revision: advanced whenever bodies, particles, bonds
+   // or particle types change, or a particle moves within its body,
+   // but not when bodies merely move as a whole.
+   unsigned int revision;
+
+   // World random numbers.
+   Random random;
+
    // Constructor.
    Mechanics();
 
@@ -86,6 +95,22 @@ public:
    // Step system by given time increment.
    void step(double dtime);
 
+   // Particle contacts: particle pairs that collided in the last step.
+   // A contact particle is set to NULL when it is removed.
+   class Contact
+   {
+public:
+      Particle *particle1;
+      Particle *particle2;
+      Contact  *next;
+      Contact()
+      {
+         particle1 = particle2 = NULL;
+         next      = NULL;
+      }
+   };
+   Contact *contacts;
+
 private:
 
    // Mark connected sets of particles.
@@ -126,5 +151,11 @@ public:
 
    // Update charge forces.
    void updateChargeForces(Body *body1);
+
+   // Clear contacts.
+   void clearContacts();
+
+   // Clear removed particle from contacts.
+   void clearContacts(Particle *particle);
 };
 #endif
@@ -21,6 +21,107 @@
 #include "Orientation.hpp"
 #include "../util/Math_etc.h"
 
+// Transform table.
+const int Orientation::transforms[NUM_ORIENTATIONS][3][3][2] =
+{
+   // Direction 0.
+   {
+      { { -1, -1 }, { -1,  0 }, { -1,  1 } },
+      { {  0, -1 }, {  0,  0 }, {  0,  1 } },
+      { {  1, -1 }, {  1,  0 }, {  1,  1 } }
+   },
+   // Direction 1.
+   {
+      { { -1,  0 }, {  0,  0 }, {  0,  1 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0, -1 }, {  0,  0 }, {  1,  0 } }
+   },
+   // Direction 2.
+   {
+      { { -1,  1 }, {  0,  1 }, {  1,  1 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1, -1 }, {  0, -1 }, {  1, -1 } }
+   },
+   // Direction 3.
+   {
+      { {  0,  1 }, {  0,  0 }, {  1,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { { -1,  0 }, {  0,  0 }, {  0, -1 } }
+   },
+   // Direction 4.
+   {
+      { {  1,  1 }, {  1,  0 }, {  1, -1 } },
+      { {  0,  1 }, {  0,  0 }, {  0, -1 } },
+      { { -1,  1 }, { -1,  0 }, { -1, -1 } }
+   },
+   // Direction 5.
+   {
+      { {  1,  0 }, {  0,  0 }, {  0, -1 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  1 }, {  0,  0 }, { -1,  0 } }
+   },
+   // Direction 6.
+   {
+      { {  1, -1 }, {  0, -1 }, { -1, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  1,  1 }, {  0,  1 }, { -1,  1 } }
+   },
+   // Direction 7.
+   {
+      { {  0, -1 }, {  0,  0 }, { -1,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  1,  0 }, {  0,  0 }, {  0,  1 } }
+   },
+   // Direction 0, mirrored.
+   {
+      { { -1, -1 }, { -1,  0 }, { -1,  1 } },
+      { {  0, -1 }, {  0,  0 }, {  0,  1 } },
+      { {  1, -1 }, {  1,  0 }, {  1,  1 } }
+   },
+   // Direction 1, mirrored.
+   {
+      { {  0, -1 }, {  0,  0 }, { -1,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  1,  0 }, {  0,  0 }, {  0,  1 } }
+   },
+   // Direction 2, mirrored.
+   {
+      { {  1, -1 }, {  0, -1 }, { -1, -1 } },
+      { {  1,  0 }, {  0,  0 }, { -1,  0 } },
+      { {  1,  1 }, {  0,  1 }, { -1,  1 } }
+   },
+   // Direction 3, mirrored.
+   {
+      { {  1,  0 }, {  0,  0 }, {  0, -1 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0,  1 }, {  0,  0 }, { -1,  0 } }
+   },
+   // Direction 4, mirrored.
+   {
+      { {  1,  1 }, {  1,  0 }, {  1, -1 } },
+      { {  0,  1 }, {  0,  0 }, {  0, -1 } },
+      { { -1,  1 }, { -1,  0 }, { -1, -1 } }
+   },
+   // Direction 5, mirrored.
+   {
+      { {  0,  1 }, {  0,  0 }, {  1,  0 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { { -1,  0 }, {  0,  0 }, {  0, -1 } }
+   },
+   // Direction 6, mirrored.
+   {
+      { { -1,  1 }, {  0,  1 }, {  1,  1 } },
+      { { -1,  0 }, {  0,  0 }, {  1,  0 } },
+      { { -1, -1 }, {  0, -1 }, {  1, -1 } }
+   },
+   // Direction 7, mirrored.
+   {
+      { { -1,  0 }, {  0,  0 }, {  0,  1 } },
+      { {  0,  0 }, {  0,  0 }, {  0,  0 } },
+      { {  0, -1 }, {  0,  0 }, {  1,  0 } }
+   }
+};
+
 // Constructors.
 Orientation::Orientation()
 {
@@ -102,6 +203,25 @@ int Orientation::aim(int amount)
 
 // Transform coordinates relative to orientation.
 void Orientation::transform(int& x, int& y)
+{
+   const int *xy;
+
+   if ((x >= -1) && (x <= 1) && (y >= -1) && (y <= 1) &&
+       (direction >= 0) && (direction < 8))
+   {
+      xy = transforms[getIndex()][x + 1][y + 1];
+      x  = xy[0];
+      y  = xy[1];
+   }
+   else
+   {
+      computeTransform(x, y);
+   }
+}
+
+
+// Compute coordinates transformed relative to orientation.
+void Orientation::computeTransform(int& x, int& y)
 {
    double angle;
    double x2, y2;
@@ -168,25 +288,29 @@ void Orientation::transform(int& x, int& y)
 }
 
 
-int Orientation::offset(int amount)
+// Get orientation index: direction, plus 8 if mirrored.
+int Orientation::getIndex()
 {
-   int i;
-
    if (mirrored)
    {
-      i = direction - amount;
+      return(direction + 8);
    }
    else
    {
-      i = direction + amount;
+      return(direction);
    }
-   while (i < 0)
+}
+
+
+// Offset direction by amount, modulo 8.
+int Orientation::offset(int amount)
+{
+   if (mirrored)
    {
-      i += 8;
+      return((direction - amount) & 7);
    }
-   while (i > 7)
+   else
    {
-      i -= 8;
+      return((direction + amount) & 7);
    }
-   return(i);
 }
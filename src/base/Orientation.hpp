@@ -23,6 +23,9 @@
 
 #include "Parameters.h"
 
+// Number of distinct orientations: 8 directions, mirrored or not.
+#define NUM_ORIENTATIONS    16
+
 class Orientation
 {
 public:
@@ -53,8 +56,20 @@ public:
    // Transform coordinates relative to orientation.
    void transform(int& x, int& y);
 
+   // Get orientation index: direction, plus 8 if mirrored.
+   int getIndex();
+
+   // Compute coordinates transformed relative to orientation,
+   // without the transform table.
+   void computeTransform(int& x, int& y);
+
 private:
 
    int offset(int amount);
+
+   // Transform table for neighborhood coordinates (-1 <= x,y <= 1),
+   // indexed by orientation index, x + 1 and y + 1. Generated from the
+   // computed transforms; TestTransforms checks that they still agree.
+   static const int transforms[NUM_ORIENTATIONS][3][3][2];
 };
 #endif
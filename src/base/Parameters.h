@@ -43,6 +43,10 @@
 #define INFINITE_ENERGY           (-1)
 #define INITIAL_ENERGY            10
 
+// To coalesce identical signal emissions absorbed by a cell
+// into a single emission counted multiple times, set COALESCE_EMISSIONS = 1
+#define COALESCE_EMISSIONS        0
+
 // To take a screen snapshot, set SNAPSHOT = 1
 #define SNAPSHOT                  0
 
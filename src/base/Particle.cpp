@@ -41,6 +41,7 @@ Particle::Particle(int type, float radius, float mass, float charge)
    body        = NULL;
    bonds       = NULL;
    next        = NULL;
+   collide     = NULL;
    propulsions = NULL;
 }
 
@@ -57,6 +58,7 @@ Particle::Particle(int type)
    body        = NULL;
    bonds       = NULL;
    next        = NULL;
+   collide     = NULL;
    propulsions = NULL;
 }
 
@@ -132,7 +134,7 @@ Bond *Particle::getBond(Particle *particle)
 
 
 // Propel particle.
-void Particle::propel(Vector3D& force, double& weight)
+void Particle::propel(Vector3D& force, double& weight, Random *random)
 {
    double            total, select, accum;
    struct Propulsion *propulsion, *newPropulsions;
@@ -144,7 +146,7 @@ void Particle::propel(Vector3D& force, double& weight)
    {
       if (propulsion->delay == 0)
       {
-         total += propulsion->weight;
+         total += propulsion->weight * propulsion->multiplicity;
       }
    }
 
@@ -158,7 +160,7 @@ void Particle::propel(Vector3D& force, double& weight)
       {
          total = 1.0;
       }
-      select = Random::nextDouble();
+      select = random->nextDouble();
       accum  = 0.0;
 
       for (propulsion = propulsions; propulsion != NULL;
@@ -170,7 +172,9 @@ void Particle::propel(Vector3D& force, double& weight)
          }
 
          // Select this propulsion?
-         accum += (propulsion->weight / total);
+         // A coalesced propulsion is selected as often as
+         // its separate instances would have been.
+         accum += ((propulsion->weight * propulsion->multiplicity) / total);
          if (select < accum)
          {
             force  = propulsion->force;
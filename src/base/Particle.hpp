@@ -28,6 +28,7 @@
 class Cell;
 class Body;
 class Bond;
+class Random;
 
 class Particle
 {
@@ -69,13 +70,14 @@ public:
    static void write(FILE *fp, Particle *particle);
 
    // Propel particle.
-   void propel(Vector3D& force, double& weight);
+   void propel(Vector3D& force, double& weight, Random *random);
 
    // Weighted propulsion vectors.
    struct Propulsion
    {
       Vector3D          force;
       double            weight;
+      int               multiplicity;
       int               delay;
       int               duration;
       struct Propulsion *next;
@@ -24,8 +24,11 @@
 Signal::Signal(Compound *type)
 {
    this->type = type;
-   parameters = NULL;
-   strength   = 0.0;
+   parameters    = NULL;
+   strength      = 0.0;
+   numParameters = 0;
+   size          = 0;
+   particleMask  = 0;
 }
 
 
@@ -34,6 +37,9 @@ Signal::Signal(Compound *type, void **parameters)
    this->type       = type;
    this->parameters = parameters;
    strength         = 0.0;
+   numParameters    = 0;
+   size             = 0;
+   particleMask     = 0;
 }
 
 
@@ -42,6 +48,51 @@ Signal::Signal(Compound *type, void **parameters, double strength)
    this->type       = type;
    this->parameters = parameters;
    this->strength   = strength;
+   numParameters    = 0;
+   size             = 0;
+   particleMask     = 0;
+}
+
+
+Signal::Signal(Compound *type, void **parameters, int numParameters,
+               double strength)
+{
+   this->type          = type;
+   this->parameters    = parameters;
+   this->numParameters = numParameters;
+   this->strength      = strength;
+   size                = 0;
+   particleMask        = 0;
+}
+
+
+// Set parameter layout.
+void Signal::setLayout(int size, unsigned int particleMask)
+{
+   this->size         = size;
+   this->particleMask = particleMask;
+}
+
+
+// Same type and payload?
+bool Signal::equals(Signal *signal)
+{
+   if ((numParameters == 0) || (numParameters != signal->numParameters))
+   {
+      return(false);
+   }
+   if (!type->equals(signal->type))
+   {
+      return(false);
+   }
+   for (int i = 0; i < numParameters; i++)
+   {
+      if (parameters[i] != signal->parameters[i])
+      {
+         return(false);
+      }
+   }
+   return(true);
 }
 
 
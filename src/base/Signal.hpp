@@ -31,10 +31,27 @@ public:
    void     **parameters;
    double   strength;
 
+   // Number of leading parameters forming the signal payload,
+   // or zero if the signal cannot be coalesced with another.
+   int numParameters;
+
+   // Parameter layout, for saving signals: number of parameters
+   // and mask of the parameters that are particles.
+   int          size;
+   unsigned int particleMask;
+
    // Constructors.
    Signal(Compound *type);
    Signal(Compound *type, void **parameters);
    Signal(Compound *type, void **parameters, double strength);
+   Signal(Compound *type, void **parameters, int numParameters,
+          double strength);
+
+   // Set parameter layout.
+   void setLayout(int size, unsigned int particleMask);
+
+   // Same type and payload?
+   bool equals(Signal *signal);
 
    // Destructor
    ~Signal();
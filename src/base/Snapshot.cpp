@@ -0,0 +1,570 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * World snapshot.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include "Snapshot.hpp"
+#include "Mechanics.hpp"
+
+// Bond pointer comparison for sorting.
+static int compareBonds(const void *bond1, const void *bond2)
+{
+   Bond *b1 = *(Bond **)bond1;
+   Bond *b2 = *(Bond **)bond2;
+
+   if (b1 < b2)
+   {
+      return(-1);
+   }
+   if (b1 > b2)
+   {
+      return(1);
+   }
+   return(0);
+}
+
+
+// Constructor: take snapshot of world.
+Snapshot::Snapshot(Mechanics *mechanics)
+{
+   int        i, j, k, n, *bondOrder;
+   Body       *body;
+   Particle   *particle;
+   Bond       *bond, **bondList;
+   BodyRecord *bodyRecord;
+
+   ParticleRecord       *particleRecord;
+   Particle::Propulsion *propulsion;
+
+   // Count records.
+   numBodies = numParticles = numBondLinks = numPropulsions = 0;
+   for (body = mechanics->bodies; body != NULL; body = body->next)
+   {
+      numBodies++;
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next)
+      {
+         numParticles++;
+         for (bond = particle->bonds; bond != NULL; )
+         {
+            numBondLinks++;
+            bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+         }
+         for (propulsion = particle->propulsions; propulsion != NULL;
+              propulsion = propulsion->next)
+         {
+            numPropulsions++;
+         }
+      }
+   }
+   // Records are value-initialized, clearing their padding, so
+   // written snapshots of identical worlds are identical.
+   bodies = new BodyRecord[numBodies + 1]();
+   assert(bodies != NULL);
+   particles = new ParticleRecord[numParticles + 1]();
+   assert(particles != NULL);
+   bondLinks = new int[numBondLinks + 1];
+   assert(bondLinks != NULL);
+   propulsions = new Particle::Propulsion[numPropulsions + 1]();
+   assert(propulsions != NULL);
+
+   // Record bodies, particles and propulsions.
+   // Particle marks are replaced by record indices.
+   bondList = new Bond *[numBondLinks + 1];
+   assert(bondList != NULL);
+   for (body = mechanics->bodies, i = j = k = 0; body != NULL;
+        body = body->next, i++)
+   {
+      bodyRecord = &bodies[i];
+#if (USE_ENERGY == 1 || STORE_ENERGY == 1)
+      bodyRecord->energy = body->energy;
+#endif
+      bodyRecord->fMass           = body->fMass;
+      bodyRecord->mInertia        = body->mInertia;
+      bodyRecord->mInertiaInverse = body->mInertiaInverse;
+      bodyRecord->vVelocity       = body->vVelocity;
+      bodyRecord->vForces         = body->vForces;
+      bodyRecord->fixedCount      = body->fixedCount;
+      bodyRecord->collide         = body->collide;
+      bodyRecord->firstParticle   = j;
+      bodyRecord->numParticles    = 0;
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, j++)
+      {
+         bodyRecord->numParticles++;
+         particleRecord                  = &particles[j];
+         particleRecord->type            = particle->type;
+         particleRecord->fRadius         = particle->fRadius;
+         particleRecord->fMass           = particle->fMass;
+         particleRecord->fCharge         = particle->fCharge;
+         particleRecord->coefficientOfRestitution = particle->coefficientOfRestitution;
+         particle->orientation.copy(&particleRecord->orientation);
+         particleRecord->vPosition       = particle->vPosition;
+         particleRecord->fixed           = particle->fixed;
+         particleRecord->mark            = particle->mark;
+         particleRecord->firstPropulsion = k;
+         particleRecord->numPropulsions  = 0;
+         for (propulsion = particle->propulsions; propulsion != NULL;
+              propulsion = propulsion->next, k++)
+         {
+            propulsions[k].force        = propulsion->force;
+            propulsions[k].weight       = propulsion->weight;
+            propulsions[k].multiplicity = propulsion->multiplicity;
+            propulsions[k].delay        = propulsion->delay;
+            propulsions[k].duration     = propulsion->duration;
+            propulsions[k].next         = NULL;
+            particleRecord->numPropulsions++;
+         }
+         particle->mark = j;
+      }
+   }
+
+   // Record bond links in particle bond list order.
+   for (body = mechanics->bodies, j = k = 0; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, j++)
+      {
+         particles[j].firstBond = k;
+         particles[j].numBonds  = 0;
+         for (bond = particle->bonds; bond != NULL; k++)
+         {
+            bondList[k] = bond;
+            particles[j].numBonds++;
+            bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+         }
+      }
+   }
+
+   // Make sorted table of distinct bonds.
+   qsort(bondList, numBondLinks, sizeof(Bond *), compareBonds);
+   for (i = j = 0; i < numBondLinks; i++)
+   {
+      if ((j == 0) || (bondList[i] != bondList[j - 1]))
+      {
+         bondList[j] = bondList[i];
+         j++;
+      }
+   }
+   numBonds = j;
+   bonds    = new BondRecord[numBonds + 1];
+   assert(bonds != NULL);
+
+   // Number bonds in order of first link, so that bond records
+   // do not depend on bond addresses, and convert bond links
+   // to bond record indices.
+   bondOrder = new int[numBonds + 1];
+   assert(bondOrder != NULL);
+   for (i = 0; i < numBonds; i++)
+   {
+      bondOrder[i] = -1;
+   }
+   for (body = mechanics->bodies, i = j = k = 0; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, j++)
+      {
+         for (bond = particle->bonds; bond != NULL; k++)
+         {
+            n = findBond(bond, bondList, numBonds);
+            if (bondOrder[n] == -1)
+            {
+               bondOrder[n]       = i;
+               bonds[i].particle1 = bond->particle1->mark;
+               bonds[i].particle2 = bond->particle2->mark;
+               bonds[i].length    = bond->length;
+               i++;
+            }
+            bondLinks[k] = bondOrder[n];
+            bond         = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+         }
+      }
+   }
+
+   // Restore marks.
+   for (body = mechanics->bodies, j = 0; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, j++)
+      {
+         particle->mark = particles[j].mark;
+      }
+   }
+   delete [] bondOrder;
+   delete [] bondList;
+
+   worldParticles = mechanics->numParticles;
+   random = mechanics->random;
+}
+
+
+// Constructor: empty snapshot.
+Snapshot::Snapshot()
+{
+   bodies         = NULL;
+   particles      = NULL;
+   bonds          = NULL;
+   bondLinks      = NULL;
+   propulsions    = NULL;
+   numBodies      = numParticles = numBonds = 0;
+   numBondLinks   = numPropulsions = 0;
+   worldParticles = 0;
+}
+
+
+// Destructor.
+Snapshot::~Snapshot()
+{
+   delete [] bodies;
+   delete [] particles;
+   delete [] bonds;
+   delete [] bondLinks;
+   delete [] propulsions;
+}
+
+
+// Restore snapshot into empty world.
+void Snapshot::restore(Mechanics *mechanics)
+{
+   int        i, j, k;
+   Body       *body, *lastBody;
+   Particle   *particle, *lastParticle, **particleList;
+   Bond       *bond, **bondList, *lastBond;
+   BodyRecord *bodyRecord;
+
+   ParticleRecord       *particleRecord;
+   Particle::Propulsion *propulsion, *lastPropulsion;
+
+   assert(mechanics->bodies == NULL);
+
+   // Restore bodies and particles in order.
+   particleList = new Particle *[numParticles + 1];
+   assert(particleList != NULL);
+   lastBody = NULL;
+   for (i = 0; i < numBodies; i++)
+   {
+      bodyRecord = &bodies[i];
+      body       = new Body();
+      assert(body != NULL);
+#if (USE_ENERGY == 1 || STORE_ENERGY == 1)
+      body->energy = bodyRecord->energy;
+#endif
+      body->fMass           = bodyRecord->fMass;
+      body->mInertia        = bodyRecord->mInertia;
+      body->mInertiaInverse = bodyRecord->mInertiaInverse;
+      body->vVelocity       = bodyRecord->vVelocity;
+      body->vForces         = bodyRecord->vForces;
+      body->fixedCount      = bodyRecord->fixedCount;
+      body->collide         = bodyRecord->collide;
+      lastParticle          = NULL;
+      for (j = bodyRecord->firstParticle;
+           j < bodyRecord->firstParticle + bodyRecord->numParticles; j++)
+      {
+         particleRecord = &particles[j];
+         particle       = new Particle(particleRecord->type,
+                                       particleRecord->fRadius, particleRecord->fMass,
+                                       particleRecord->fCharge);
+         assert(particle != NULL);
+         particle->coefficientOfRestitution = particleRecord->coefficientOfRestitution;
+         particleRecord->orientation.copy(&particle->orientation);
+         particle->vPosition = particleRecord->vPosition;
+         particle->fixed     = particleRecord->fixed;
+         particle->mark      = particleRecord->mark;
+         particle->body      = body;
+         lastPropulsion      = NULL;
+         for (k = particleRecord->firstPropulsion;
+              k < particleRecord->firstPropulsion + particleRecord->numPropulsions; k++)
+         {
+            propulsion = new Particle::Propulsion;
+            assert(propulsion != NULL);
+            *propulsion = propulsions[k];
+            if (lastPropulsion == NULL)
+            {
+               particle->propulsions = propulsion;
+            }
+            else
+            {
+               lastPropulsion->next = propulsion;
+            }
+            lastPropulsion = propulsion;
+         }
+         if (lastParticle == NULL)
+         {
+            body->particles = particle;
+         }
+         else
+         {
+            lastParticle->next = particle;
+         }
+         lastParticle    = particle;
+         particleList[j] = particle;
+      }
+      if (lastBody == NULL)
+      {
+         mechanics->bodies = body;
+      }
+      else
+      {
+         lastBody->next = body;
+      }
+      lastBody = body;
+   }
+
+   // Restore bonds.
+   bondList = new Bond *[numBonds + 1];
+   assert(bondList != NULL);
+   for (i = 0; i < numBonds; i++)
+   {
+      bond = new Bond(particleList[bonds[i].particle1],
+                      particleList[bonds[i].particle2]);
+      assert(bond != NULL);
+      bond->length = bonds[i].length;
+      bondList[i]  = bond;
+   }
+
+   // Restore particle bond lists in order.
+   for (j = 0; j < numParticles; j++)
+   {
+      particle = particleList[j];
+      lastBond = NULL;
+      for (k = particles[j].firstBond;
+           k < particles[j].firstBond + particles[j].numBonds; k++)
+      {
+         bond = bondList[bondLinks[k]];
+         if (lastBond == NULL)
+         {
+            particle->bonds = bond;
+         }
+         else if (lastBond->particle1 == particle)
+         {
+            lastBond->next1 = bond;
+         }
+         else
+         {
+            lastBond->next2 = bond;
+         }
+         lastBond = bond;
+      }
+   }
+   delete [] bondList;
+   delete [] particleList;
+
+   mechanics->numParticles = worldParticles;
+   mechanics->revision++;
+   mechanics->random = random;
+}
+
+
+// Write snapshot in binary form: record counts followed by records
+// (false if not written).
+bool Snapshot::write(FILE *fp)
+{
+   return((fwrite(&numBodies, sizeof(numBodies), 1, fp) == 1) &&
+          (fwrite(&numParticles, sizeof(numParticles), 1, fp) == 1) &&
+          (fwrite(&numBonds, sizeof(numBonds), 1, fp) == 1) &&
+          (fwrite(&numBondLinks, sizeof(numBondLinks), 1, fp) == 1) &&
+          (fwrite(&numPropulsions, sizeof(numPropulsions), 1, fp) == 1) &&
+          (fwrite(bodies, sizeof(BodyRecord), numBodies, fp) ==
+           (size_t)numBodies) &&
+          (fwrite(particles, sizeof(ParticleRecord), numParticles, fp) ==
+           (size_t)numParticles) &&
+          (fwrite(bonds, sizeof(BondRecord), numBonds, fp) ==
+           (size_t)numBonds) &&
+          (fwrite(bondLinks, sizeof(int), numBondLinks, fp) ==
+           (size_t)numBondLinks) &&
+          (fwrite(propulsions, sizeof(Particle::Propulsion), numPropulsions, fp) ==
+           (size_t)numPropulsions) &&
+          (fwrite(&worldParticles, sizeof(worldParticles), 1, fp) == 1) &&
+          (fwrite(&random, sizeof(random), 1, fp) == 1));
+}
+
+
+// Read snapshot written in binary form (NULL if unreadable).
+Snapshot *Snapshot::read(FILE *fp)
+{
+   long     position, end;
+   Snapshot *snapshot = new Snapshot();
+
+   assert(snapshot != NULL);
+   if ((fread(&snapshot->numBodies, sizeof(snapshot->numBodies), 1, fp) != 1) ||
+       (fread(&snapshot->numParticles, sizeof(snapshot->numParticles), 1, fp) != 1) ||
+       (fread(&snapshot->numBonds, sizeof(snapshot->numBonds), 1, fp) != 1) ||
+       (fread(&snapshot->numBondLinks, sizeof(snapshot->numBondLinks), 1, fp) != 1) ||
+       (fread(&snapshot->numPropulsions, sizeof(snapshot->numPropulsions), 1, fp) != 1) ||
+       (snapshot->numBodies < 0) || (snapshot->numParticles < 0) ||
+       (snapshot->numBonds < 0) || (snapshot->numBondLinks < 0) ||
+       (snapshot->numPropulsions < 0))
+   {
+      delete snapshot;
+      return(NULL);
+   }
+
+   // Counts must fit in the rest of the file (when it can be sized),
+   // so that a damaged count does not make a huge allocation.
+   position = ftell(fp);
+   if ((position != -1) && (fseek(fp, 0, SEEK_END) == 0))
+   {
+      end = ftell(fp);
+      if ((fseek(fp, position, SEEK_SET) != 0) ||
+          ((double)(end - position) <
+           (double)snapshot->numBodies * sizeof(BodyRecord) +
+           (double)snapshot->numParticles * sizeof(ParticleRecord) +
+           (double)snapshot->numBonds * sizeof(BondRecord) +
+           (double)snapshot->numBondLinks * sizeof(int) +
+           (double)snapshot->numPropulsions * sizeof(Particle::Propulsion)))
+      {
+         delete snapshot;
+         return(NULL);
+      }
+   }
+   snapshot->bodies = new BodyRecord[snapshot->numBodies + 1];
+   assert(snapshot->bodies != NULL);
+   snapshot->particles = new ParticleRecord[snapshot->numParticles + 1];
+   assert(snapshot->particles != NULL);
+   snapshot->bonds = new BondRecord[snapshot->numBonds + 1];
+   assert(snapshot->bonds != NULL);
+   snapshot->bondLinks = new int[snapshot->numBondLinks + 1];
+   assert(snapshot->bondLinks != NULL);
+   snapshot->propulsions = new Particle::Propulsion[snapshot->numPropulsions + 1];
+   assert(snapshot->propulsions != NULL);
+   if ((fread(snapshot->bodies, sizeof(BodyRecord), snapshot->numBodies, fp) !=
+        (size_t)snapshot->numBodies) ||
+       (fread(snapshot->particles, sizeof(ParticleRecord), snapshot->numParticles, fp) !=
+        (size_t)snapshot->numParticles) ||
+       (fread(snapshot->bonds, sizeof(BondRecord), snapshot->numBonds, fp) !=
+        (size_t)snapshot->numBonds) ||
+       (fread(snapshot->bondLinks, sizeof(int), snapshot->numBondLinks, fp) !=
+        (size_t)snapshot->numBondLinks) ||
+       (fread(snapshot->propulsions, sizeof(Particle::Propulsion),
+              snapshot->numPropulsions, fp) != (size_t)snapshot->numPropulsions) ||
+       (fread(&snapshot->worldParticles, sizeof(snapshot->worldParticles), 1, fp) != 1) ||
+       (fread(&snapshot->random, sizeof(snapshot->random), 1, fp) != 1) ||
+       !snapshot->check())
+   {
+      delete snapshot;
+      return(NULL);
+   }
+   return(snapshot);
+}
+
+
+// Check that read records are consistent and can be restored:
+// bodies, bond links and propulsions are consecutive and cover all
+// records, bonds join two distinct particles, and each bond is linked
+// once from each of its particles.
+bool Snapshot::check()
+{
+   int  i, j, k, p, *bondEnds;
+   bool valid;
+
+   if ((numBondLinks != numBonds * 2) || (worldParticles < 0))
+   {
+      return(false);
+   }
+   for (i = j = 0; i < numBodies; i++)
+   {
+      if ((bodies[i].firstParticle != j) || (bodies[i].numParticles < 0) ||
+          (bodies[i].numParticles > numParticles - j))
+      {
+         return(false);
+      }
+      j += bodies[i].numParticles;
+   }
+   if (j != numParticles)
+   {
+      return(false);
+   }
+   for (i = 0; i < numBonds; i++)
+   {
+      if ((bonds[i].particle1 < 0) || (bonds[i].particle1 >= numParticles) ||
+          (bonds[i].particle2 < 0) || (bonds[i].particle2 >= numParticles) ||
+          (bonds[i].particle1 == bonds[i].particle2))
+      {
+         return(false);
+      }
+   }
+   bondEnds = new int[numBonds + 1];
+   assert(bondEnds != NULL);
+   for (i = 0; i < numBonds; i++)
+   {
+      bondEnds[i] = 0;
+   }
+   valid = true;
+   for (j = k = p = 0; valid && j < numParticles; j++)
+   {
+      if ((particles[j].orientation.direction < NORTH) ||
+          (particles[j].orientation.direction > NORTHWEST) ||
+          (particles[j].firstBond != k) || (particles[j].numBonds < 0) ||
+          (particles[j].numBonds > numBondLinks - k) ||
+          (particles[j].firstPropulsion != p) ||
+          (particles[j].numPropulsions < 0) ||
+          (particles[j].numPropulsions > numPropulsions - p))
+      {
+         valid = false;
+         break;
+      }
+      p += particles[j].numPropulsions;
+      for (i = 0; i < particles[j].numBonds; i++, k++)
+      {
+         if ((bondLinks[k] < 0) || (bondLinks[k] >= numBonds))
+         {
+            valid = false;
+         }
+         else if ((bonds[bondLinks[k]].particle1 == j) &&
+                  ((bondEnds[bondLinks[k]] & 1) == 0))
+         {
+            bondEnds[bondLinks[k]] |= 1;
+         }
+         else if ((bonds[bondLinks[k]].particle2 == j) &&
+                  ((bondEnds[bondLinks[k]] & 2) == 0))
+         {
+            bondEnds[bondLinks[k]] |= 2;
+         }
+         else
+         {
+            valid = false;
+         }
+      }
+   }
+   delete [] bondEnds;
+   if (!valid || (k != numBondLinks) || (p != numPropulsions))
+   {
+      return(false);
+   }
+
+   // Propulsion links are not kept.
+   for (i = 0; i < numPropulsions; i++)
+   {
+      propulsions[i].next = NULL;
+   }
+   return(true);
+}
+
+
+// Find record index of bond in sorted bond list.
+int Snapshot::findBond(Bond *bond, Bond **bondList, int numBonds)
+{
+   Bond **entry;
+
+   entry = (Bond **)bsearch(&bond, bondList, numBonds, sizeof(Bond *),
+                            compareBonds);
+   assert(entry != NULL);
+   return((int)(entry - bondList));
+}
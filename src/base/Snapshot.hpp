@@ -0,0 +1,126 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * World snapshot.
+ * A flat copy of the bodies, particles and bonds of a mechanics
+ * world and of its random number generator, from which
+ * identical worlds can be restored without repeating their setup.
+ * Collision state is not kept: it is rebuilt by the next step.
+ */
+
+#ifndef __SNAPSHOT__
+#define __SNAPSHOT__
+
+#include <stdio.h>
+
+#include "Parameters.h"
+#include "Physics.h"
+#include "Orientation.hpp"
+#include "Particle.hpp"
+#include "../util/Random.hpp"
+
+class Mechanics;
+
+class Snapshot
+{
+public:
+
+   // Constructor: take snapshot of world.
+   Snapshot(Mechanics *mechanics);
+
+   // Destructor.
+   ~Snapshot();
+
+   // Restore snapshot into empty world.
+   void restore(Mechanics *mechanics);
+
+   // Write snapshot in binary form (false if not written).
+   bool write(FILE *fp);
+
+   // Read snapshot written in binary form (NULL if unreadable).
+   static Snapshot *read(FILE *fp);
+
+private:
+
+   // Constructor: empty snapshot.
+   Snapshot();
+
+   // Body record: particles are consecutive particle records.
+   struct BodyRecord
+   {
+#if (USE_ENERGY == 1 || STORE_ENERGY == 1)
+      int       energy;
+#endif
+      float     fMass;
+      Matrix3x3 mInertia;
+      Matrix3x3 mInertiaInverse;
+      Vector3D  vVelocity;
+      Vector3D  vForces;
+      int       fixedCount;
+      bool      collide;
+      int       firstParticle;
+      int       numParticles;
+   };
+
+   // Particle record: bonds and propulsions are consecutive
+   // bond link and propulsion records.
+   // Particles are referenced by record index (-1 = none).
+   struct ParticleRecord
+   {
+      int         type;
+      float       fRadius;
+      float       fMass;
+      float       fCharge;
+      float       coefficientOfRestitution;
+      Orientation orientation;
+      Vector3D    vPosition;
+      bool        fixed;
+      int         mark;
+      int         firstBond;
+      int         numBonds;
+      int         firstPropulsion;
+      int         numPropulsions;
+   };
+
+   // Bond record.
+   struct BondRecord
+   {
+      int    particle1;
+      int    particle2;
+      double length;
+   };
+
+   BodyRecord           *bodies;
+   int                  numBodies;
+   ParticleRecord       *particles;
+   int                  numParticles;
+   BondRecord           *bonds;
+   int                  numBonds;
+   int                  *bondLinks;
+   int                  numBondLinks;
+   Particle::Propulsion *propulsions;
+   int                  numPropulsions;
+   int                  worldParticles;
+   Random               random;
+
+   // Find record index of bond in sorted bond list.
+   static int findBond(Bond *bond, Bond **bondList, int numBonds);
+
+   // Check that read records are consistent and can be restored.
+   bool check();
+};
+#endif
@@ -0,0 +1,902 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Trajectory.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "Trajectory.hpp"
+#include "Mechanics.hpp"
+
+// Particle index comparison by particle address for sorting.
+static int compareParticles(const void *entry1, const void *entry2)
+{
+   Particle *p1 = *(Particle **)entry1;
+   Particle *p2 = *(Particle **)entry2;
+
+   if (p1 < p2)
+   {
+      return(-1);
+   }
+   if (p1 > p2)
+   {
+      return(1);
+   }
+   return(0);
+}
+
+
+// Bond comparison by particle indices for sorting.
+static int compareBonds(const void *bond1, const void *bond2)
+{
+   Trajectory::BondState *b1 = (Trajectory::BondState *)bond1;
+   Trajectory::BondState *b2 = (Trajectory::BondState *)bond2;
+
+   if (b1->particle1 != b2->particle1)
+   {
+      return(b1->particle1 - b2->particle1);
+   }
+   return(b1->particle2 - b2->particle2);
+}
+
+
+// Position in fixed point.
+static int fixPosition(float position)
+{
+   return((int)floor((position * (float)TRAJECTORY_SCALE) + 0.5f));
+}
+
+
+// Constructor: record to file with keyframe interval (0 = first
+// frame only), or play from file.
+Trajectory::Trajectory(FILE *fp, bool record, int keyInterval)
+{
+   Header header;
+
+   this->fp      = fp;
+   recording     = record;
+   valid         = true;
+   ended         = false;
+   step          = -1;
+   numParticles  = numBonds = 0;
+   particles     = NULL;
+   bonds         = NULL;
+   particleIndex = NULL;
+   buffer        = NULL;
+   bufferSize    = length = position = 0;
+   if (recording)
+   {
+      this->keyInterval = keyInterval;
+      memset(&header, 0, sizeof(header));
+      strncpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+      header.version     = TRAJECTORY_VERSION;
+      header.width       = WIDTH;
+      header.height      = HEIGHT;
+      header.scale       = TRAJECTORY_SCALE;
+      header.keyInterval = keyInterval;
+      fwrite(&header, sizeof(header), 1, fp);
+   }
+   else
+   {
+      if ((fread(&header, sizeof(header), 1, fp) != 1) ||
+          (strncmp(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic)) != 0) ||
+          (header.version != TRAJECTORY_VERSION) ||
+          (header.scale != TRAJECTORY_SCALE))
+      {
+         valid = false;
+      }
+      this->keyInterval = header.keyInterval;
+   }
+   start = ftell(fp);
+}
+
+
+// Destructor: a recording is ended.
+Trajectory::~Trajectory()
+{
+   if (recording)
+   {
+      length = 0;
+      write(END_FRAME);
+   }
+   delete [] particles;
+   delete [] bonds;
+   delete [] particleIndex;
+   delete [] buffer;
+}
+
+
+// Record frame of world.
+void Trajectory::record(Mechanics *mechanics)
+{
+   int           i, numStates, numBondStates;
+   Body          *body;
+   Particle      *particle;
+   ParticleState *states, *state;
+   ParticleIndex *index;
+   BondState     *bondStates;
+
+   // Get particles in world order.
+   for (body = mechanics->bodies, numStates = 0; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next)
+      {
+         numStates++;
+      }
+   }
+   states = new ParticleState[numStates + 1];
+   assert(states != NULL);
+   index = new ParticleIndex[numStates + 1];
+   assert(index != NULL);
+   for (body = mechanics->bodies, i = 0; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next, i++)
+      {
+         state              = &states[i];
+         state->type        = particle->type;
+         state->orientation = particle->orientation.getIndex();
+         state->x           = fixPosition(particle->vPosition.x);
+         state->y           = fixPosition(particle->vPosition.y);
+         index[i].particle  = particle;
+         index[i].index     = i;
+      }
+   }
+   qsort(index, numStates, sizeof(ParticleIndex), compareParticles);
+   numBondStates = findBonds(index, numStates, bondStates);
+
+   // Encode frame.
+   step++;
+   length = 0;
+   if ((particleIndex == NULL) ||
+       ((keyInterval > 0) && ((step % keyInterval) == 0)))
+   {
+      recordKey(states, numStates, bondStates, numBondStates);
+      write(KEY_FRAME);
+   }
+   else
+   {
+      recordDelta(states, numStates, index, bondStates, numBondStates);
+      write(DELTA_FRAME);
+   }
+
+   // Frame becomes previous frame.
+   delete [] particles;
+   delete [] bonds;
+   delete [] particleIndex;
+   particles     = states;
+   numParticles  = numStates;
+   bonds         = bondStates;
+   numBonds      = numBondStates;
+   particleIndex = index;
+}
+
+
+// Encode keyframe.
+void Trajectory::recordKey(ParticleState *states, int numStates,
+                           BondState *bondStates, int numBondStates)
+{
+   int i;
+
+   putValue(numStates);
+   for (i = 0; i < numStates; i++)
+   {
+      putParticle(&states[i]);
+   }
+   putBonds(bondStates, numBondStates);
+}
+
+
+// Encode delta frame from previous frame.
+void Trajectory::recordDelta(ParticleState *states, int numStates,
+                             ParticleIndex *index, BondState *bondStates,
+                             int numBondStates)
+{
+   int           i, p, last, flags, *previousIndex, *mapping;
+   int           numMapped, numRemoved, numAdded, m, b;
+   ParticleState *state, *previous;
+   ParticleIndex *entry;
+   BondState     *mapped, *removed, *added;
+
+   // Find previous frame index of each particle, and frame
+   // index of each previous frame particle (-1 if gone).
+   previousIndex = new int[numStates + 1];
+   assert(previousIndex != NULL);
+   mapping = new int[numParticles + 1];
+   assert(mapping != NULL);
+   for (p = 0; p < numParticles; p++)
+   {
+      mapping[p] = -1;
+   }
+   for (i = 0; i < numStates; i++)
+   {
+      entry = (ParticleIndex *)bsearch(&index[i], particleIndex, numParticles,
+                                       sizeof(ParticleIndex), compareParticles);
+      if (entry != NULL)
+      {
+         previousIndex[index[i].index] = entry->index;
+         mapping[entry->index]         = index[i].index;
+      }
+      else
+      {
+         previousIndex[index[i].index] = -1;
+      }
+   }
+
+   // Encode particles.
+   putValue(numStates);
+   for (i = 0, last = -1; i < numStates; i++)
+   {
+      state = &states[i];
+      p     = previousIndex[i];
+      if (p == -1)
+      {
+         putValue(NEW_PARTICLE);
+         putParticle(state);
+         continue;
+      }
+      previous = &particles[p];
+      flags    = 0;
+      if (p == last + 1)
+      {
+         flags |= NEXT_PARTICLE;
+      }
+      if (state->type != previous->type)
+      {
+         flags |= TYPE_CHANGED;
+      }
+      if (state->orientation != previous->orientation)
+      {
+         flags |= ORIENTATION_CHANGED;
+      }
+      if ((state->x != previous->x) || (state->y != previous->y))
+      {
+         flags |= MOVED;
+      }
+      putValue(flags);
+      if (!(flags & NEXT_PARTICLE))
+      {
+         putSigned(p - (last + 1));
+      }
+      if (flags & TYPE_CHANGED)
+      {
+         putSigned(state->type);
+      }
+      if (flags & ORIENTATION_CHANGED)
+      {
+         putValue(state->orientation);
+      }
+      if (flags & MOVED)
+      {
+         putSigned(state->x - previous->x);
+         putSigned(state->y - previous->y);
+      }
+      last = p;
+   }
+
+   // Encode bond changes between previous bonds of continuing
+   // particles and bonds: both are sorted.
+   numMapped = mapBonds(bonds, numBonds, mapping, mapped);
+   removed   = new BondState[numMapped + 1];
+   assert(removed != NULL);
+   added = new BondState[numBondStates + 1];
+   assert(added != NULL);
+   numRemoved = numAdded = 0;
+   for (m = b = 0; (m < numMapped) || (b < numBondStates); )
+   {
+      if (b == numBondStates)
+      {
+         removed[numRemoved++] = mapped[m++];
+      }
+      else if (m == numMapped)
+      {
+         added[numAdded++] = bondStates[b++];
+      }
+      else if (compareBonds(&mapped[m], &bondStates[b]) < 0)
+      {
+         removed[numRemoved++] = mapped[m++];
+      }
+      else if (compareBonds(&mapped[m], &bondStates[b]) > 0)
+      {
+         added[numAdded++] = bondStates[b++];
+      }
+      else
+      {
+         m++;
+         b++;
+      }
+   }
+   putBonds(removed, numRemoved);
+   putBonds(added, numAdded);
+
+   delete [] added;
+   delete [] removed;
+   delete [] mapped;
+   delete [] mapping;
+   delete [] previousIndex;
+}
+
+
+// Play next frame (false if none).
+bool Trajectory::play()
+{
+   FrameHeader frameHeader;
+   long        offset, end;
+   bool        played;
+
+   if (recording || !valid || ended)
+   {
+      return(false);
+   }
+   if ((fread(&frameHeader, sizeof(frameHeader), 1, fp) != 1) ||
+       (frameHeader.type == END_FRAME))
+   {
+      ended = true;
+      return(false);
+   }
+   if (frameHeader.length < 0)
+   {
+      valid = false;
+      return(false);
+   }
+
+   // The frame must fit in the rest of the file (when it can be sized),
+   // so that a damaged length does not make a huge allocation.
+   offset = ftell(fp);
+   if ((offset != -1) && (fseek(fp, 0, SEEK_END) == 0))
+   {
+      end = ftell(fp);
+      if ((fseek(fp, offset, SEEK_SET) != 0) ||
+          ((long)frameHeader.length > end - offset))
+      {
+         valid = false;
+         return(false);
+      }
+   }
+   reserve(frameHeader.length);
+   if ((int)fread(buffer, 1, frameHeader.length, fp) != frameHeader.length)
+   {
+      valid = false;
+      return(false);
+   }
+   length   = frameHeader.length;
+   position = 0;
+   if (frameHeader.type == KEY_FRAME)
+   {
+      played = playKey();
+   }
+   else if ((frameHeader.type == DELTA_FRAME) && (particles != NULL))
+   {
+      played = playDelta();
+   }
+   else
+   {
+      played = false;
+   }
+   if (!played)
+   {
+      valid = false;
+      return(false);
+   }
+   step = frameHeader.step;
+   return(true);
+}
+
+
+// Play frame of given step (false if none).
+// Frames are skipped up to the last keyframe at or before the step.
+bool Trajectory::seek(int step)
+{
+   FrameHeader frameHeader;
+   long        keyPosition;
+
+   if (recording || !valid || (step < 0))
+   {
+      return(false);
+   }
+   fseek(fp, start, SEEK_SET);
+   ended       = false;
+   keyPosition = -1;
+   while (fread(&frameHeader, sizeof(frameHeader), 1, fp) == 1)
+   {
+      if (frameHeader.type == END_FRAME)
+      {
+         ended = true;
+         break;
+      }
+      if (frameHeader.step > step)
+      {
+         break;
+      }
+      if (frameHeader.type == KEY_FRAME)
+      {
+         keyPosition = ftell(fp) - (long)sizeof(frameHeader);
+      }
+      fseek(fp, frameHeader.length, SEEK_CUR);
+   }
+   if (keyPosition == -1)
+   {
+      return(false);
+   }
+   fseek(fp, keyPosition, SEEK_SET);
+   ended = false;
+   while (play())
+   {
+      if (this->step == step)
+      {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+
+// Decode keyframe.
+bool Trajectory::playKey()
+{
+   int          i;
+   unsigned int count;
+
+   // Each particle takes at least four bytes.
+   if (!getValue(count) || (count > (unsigned int)(length - position) / 4))
+   {
+      return(false);
+   }
+   delete [] particles;
+   numParticles = (int)count;
+   particles    = new ParticleState[numParticles + 1];
+   assert(particles != NULL);
+   for (i = 0; i < numParticles; i++)
+   {
+      if (!getParticle(&particles[i]))
+      {
+         return(false);
+      }
+   }
+   delete [] bonds;
+   bonds    = NULL;
+   numBonds = 0;
+   return(getBonds(bonds, numBonds, numParticles));
+}
+
+
+// Decode delta frame onto previous frame.
+bool Trajectory::playDelta()
+{
+   int           i, p, last, numStates, *mapping;
+   int           numMapped, numRemoved, numAdded, m, r, a, n;
+   unsigned int  count, flags, value;
+   ParticleState *states, *state;
+   BondState     *mapped, *removed, *added, *bondStates;
+   bool          decoded;
+
+   // Each particle takes at least a flags byte.
+   if (!getValue(count) || (count > (unsigned int)(length - position)))
+   {
+      return(false);
+   }
+   numStates = (int)count;
+   states    = new ParticleState[numStates + 1];
+   assert(states != NULL);
+   mapping = new int[numParticles + 1];
+   assert(mapping != NULL);
+   for (p = 0; p < numParticles; p++)
+   {
+      mapping[p] = -1;
+   }
+
+   // Decode particles.
+   decoded = true;
+   for (i = 0, last = -1; decoded && (i < numStates); i++)
+   {
+      state = &states[i];
+      if (!getValue(flags))
+      {
+         decoded = false;
+         break;
+      }
+      if (flags & NEW_PARTICLE)
+      {
+         decoded = getParticle(state);
+         continue;
+      }
+      p = last + 1;
+      if (!(flags & NEXT_PARTICLE))
+      {
+         if (!getSigned(n))
+         {
+            decoded = false;
+            break;
+         }
+         p += n;
+      }
+      if ((p < 0) || (p >= numParticles) || (mapping[p] != -1))
+      {
+         decoded = false;
+         break;
+      }
+      *state     = particles[p];
+      mapping[p] = i;
+      last       = p;
+      if ((flags & TYPE_CHANGED) && !getSigned(state->type))
+      {
+         decoded = false;
+      }
+      if ((flags & ORIENTATION_CHANGED) && decoded)
+      {
+         if (getValue(value) && (value < NUM_ORIENTATIONS))
+         {
+            state->orientation = (int)value;
+         }
+         else
+         {
+            decoded = false;
+         }
+      }
+      if ((flags & MOVED) && decoded)
+      {
+         if (getSigned(n))
+         {
+            state->x += n;
+         }
+         else
+         {
+            decoded = false;
+         }
+         if (decoded && getSigned(n))
+         {
+            state->y += n;
+         }
+         else
+         {
+            decoded = false;
+         }
+      }
+   }
+   if (!decoded)
+   {
+      delete [] mapping;
+      delete [] states;
+      return(false);
+   }
+
+   // Decode bond changes and apply them to previous bonds
+   // of continuing particles: all are sorted. Removed bonds must
+   // exist, and added bonds must not.
+   numMapped = mapBonds(bonds, numBonds, mapping, mapped);
+   removed   = added = NULL;
+   if (!getBonds(removed, numRemoved, numStates) ||
+       !getBonds(added, numAdded, numStates))
+   {
+      delete [] removed;
+      delete [] added;
+      delete [] mapped;
+      delete [] mapping;
+      delete [] states;
+      return(false);
+   }
+   bondStates = new BondState[numMapped + numAdded + 1];
+   assert(bondStates != NULL);
+   for (m = r = a = n = 0; decoded && ((m < numMapped) || (a < numAdded)); )
+   {
+      if ((m < numMapped) && (r < numRemoved) &&
+          (compareBonds(&mapped[m], &removed[r]) == 0))
+      {
+         m++;
+         r++;
+      }
+      else if ((m < numMapped) && (a < numAdded) &&
+               (compareBonds(&mapped[m], &added[a]) == 0))
+      {
+         decoded = false;
+      }
+      else if ((a == numAdded) ||
+               ((m < numMapped) && (compareBonds(&mapped[m], &added[a]) < 0)))
+      {
+         bondStates[n++] = mapped[m++];
+      }
+      else
+      {
+         bondStates[n++] = added[a++];
+      }
+   }
+   if (r != numRemoved)
+   {
+      decoded = false;
+   }
+   delete [] removed;
+   delete [] added;
+   delete [] mapped;
+   delete [] mapping;
+
+   // Frame becomes previous frame.
+   delete [] particles;
+   delete [] bonds;
+   particles    = states;
+   numParticles = numStates;
+   bonds        = bondStates;
+   numBonds     = n;
+   return(decoded);
+}
+
+
+// Find bonds of recorded particles, in index order.
+// Each bond is linked from both of its particles, and is
+// found from the one with the lower index.
+int Trajectory::findBonds(ParticleIndex *index, int numIndex,
+                          BondState *& bondStates)
+{
+   int           i, numLinks, numBondStates;
+   Particle      *particle, *particle2;
+   Bond          *bond;
+   ParticleIndex key, *entry;
+
+   for (i = numLinks = 0; i < numIndex; i++)
+   {
+      particle = index[i].particle;
+      for (bond = particle->bonds; bond != NULL; numLinks++)
+      {
+         bond = (bond->particle1 == particle) ? bond->next1 : bond->next2;
+      }
+   }
+   bondStates = new BondState[(numLinks / 2) + 1];
+   assert(bondStates != NULL);
+   for (i = numBondStates = 0; i < numIndex; i++)
+   {
+      particle = index[i].particle;
+      for (bond = particle->bonds; bond != NULL; )
+      {
+         if (bond->particle1 == particle)
+         {
+            particle2 = bond->particle2;
+            bond      = bond->next1;
+         }
+         else
+         {
+            particle2 = bond->particle1;
+            bond      = bond->next2;
+         }
+         key.particle = particle2;
+         entry        = (ParticleIndex *)bsearch(&key, index, numIndex,
+                                                 sizeof(ParticleIndex), compareParticles);
+         if ((entry != NULL) && (entry->index > index[i].index) &&
+             (numBondStates < (numLinks / 2)))
+         {
+            bondStates[numBondStates].particle1 = index[i].index;
+            bondStates[numBondStates].particle2 = entry->index;
+            numBondStates++;
+         }
+      }
+   }
+   qsort(bondStates, numBondStates, sizeof(BondState), compareBonds);
+   return(numBondStates);
+}
+
+
+// Map bonds of previous frame particles to their current frame
+// indices, dropping bonds of particles that are gone.
+int Trajectory::mapBonds(BondState *bondStates, int numBondStates,
+                         int *mapping, BondState *& mappedStates)
+{
+   int i, p1, p2, numMapped;
+
+   mappedStates = new BondState[numBondStates + 1];
+   assert(mappedStates != NULL);
+   for (i = numMapped = 0; i < numBondStates; i++)
+   {
+      p1 = mapping[bondStates[i].particle1];
+      p2 = mapping[bondStates[i].particle2];
+      if ((p1 == -1) || (p2 == -1))
+      {
+         continue;
+      }
+      if (p1 < p2)
+      {
+         mappedStates[numMapped].particle1 = p1;
+         mappedStates[numMapped].particle2 = p2;
+      }
+      else
+      {
+         mappedStates[numMapped].particle1 = p2;
+         mappedStates[numMapped].particle2 = p1;
+      }
+      numMapped++;
+   }
+   qsort(mappedStates, numMapped, sizeof(BondState), compareBonds);
+   return(numMapped);
+}
+
+
+// Reserve encoded frame buffer size.
+void Trajectory::reserve(int size)
+{
+   unsigned char *buffer2;
+
+   if (size <= bufferSize)
+   {
+      return;
+   }
+   if (size < (bufferSize * 2))
+   {
+      size = bufferSize * 2;
+   }
+   buffer2 = new unsigned char[size];
+   assert(buffer2 != NULL);
+   if (length > 0)
+   {
+      memcpy(buffer2, buffer, length);
+   }
+   delete [] buffer;
+   buffer     = buffer2;
+   bufferSize = size;
+}
+
+
+// Encode value: 7 bits per byte, high bit set if more follow.
+void Trajectory::putValue(unsigned int value)
+{
+   reserve(length + 5);
+   while (value >= 0x80)
+   {
+      buffer[length++] = (unsigned char)((value & 0x7f) | 0x80);
+      value          >>= 7;
+   }
+   buffer[length++] = (unsigned char)value;
+}
+
+
+// Encode signed value: zigzag encoding keeps small magnitudes small.
+void Trajectory::putSigned(int value)
+{
+   putValue(((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+}
+
+
+// Encode particle.
+void Trajectory::putParticle(ParticleState *state)
+{
+   putSigned(state->type);
+   putValue(state->orientation);
+   putSigned(state->x);
+   putSigned(state->y);
+}
+
+
+// Encode sorted bonds: number of bonds, then for each bond its
+// first particle index offset from that of the preceding bond
+// and its second particle offset from its first.
+void Trajectory::putBonds(BondState *bondStates, int numBondStates)
+{
+   int i, last;
+
+   putValue(numBondStates);
+   for (i = 0, last = 0; i < numBondStates; i++)
+   {
+      putValue(bondStates[i].particle1 - last);
+      putValue(bondStates[i].particle2 - bondStates[i].particle1 - 1);
+      last = bondStates[i].particle1;
+   }
+}
+
+
+// Write encoded frame.
+void Trajectory::write(int type)
+{
+   FrameHeader frameHeader;
+
+   frameHeader.type   = type;
+   frameHeader.step   = step;
+   frameHeader.length = length;
+   fwrite(&frameHeader, sizeof(frameHeader), 1, fp);
+   if (length > 0)
+   {
+      fwrite(buffer, 1, length, fp);
+   }
+   if (type == END_FRAME)
+   {
+      fflush(fp);
+   }
+}
+
+
+// Decode value.
+bool Trajectory::getValue(unsigned int& value)
+{
+   int shift;
+
+   value = 0;
+   for (shift = 0; (position < length) && (shift < 35); shift += 7)
+   {
+      value |= (unsigned int)(buffer[position] & 0x7f) << shift;
+      if ((buffer[position++] & 0x80) == 0)
+      {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+
+// Decode signed value.
+bool Trajectory::getSigned(int& value)
+{
+   unsigned int zigzag;
+
+   if (!getValue(zigzag))
+   {
+      return(false);
+   }
+   value = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+   return(true);
+}
+
+
+// Decode particle.
+bool Trajectory::getParticle(ParticleState *state)
+{
+   unsigned int orientation;
+
+   if (!getSigned(state->type) || !getValue(orientation) ||
+       (orientation >= NUM_ORIENTATIONS) ||
+       !getSigned(state->x) || !getSigned(state->y))
+   {
+      return(false);
+   }
+   state->orientation = (int)orientation;
+   return(true);
+}
+
+
+// Decode sorted bonds between numStates particles: bonds must be
+// distinct, in order and between particles in range.
+bool Trajectory::getBonds(BondState *& bondStates, int& numBondStates,
+                          int numStates)
+{
+   int          i, last;
+   unsigned int count, value, value2;
+
+   // Each bond takes at least two bytes.
+   numBondStates = 0;
+   if (!getValue(count) || (count > (unsigned int)(length - position) / 2))
+   {
+      return(false);
+   }
+   bondStates = new BondState[count + 1];
+   assert(bondStates != NULL);
+   for (i = 0, last = 0; i < (int)count; i++)
+   {
+      if (!getValue(value) || !getValue(value2) ||
+          (value >= (unsigned int)(numStates - last)) ||
+          (value2 >= (unsigned int)(numStates - last - (int)value - 1)))
+      {
+         return(false);
+      }
+      bondStates[i].particle1 = last + (int)value;
+      bondStates[i].particle2 = bondStates[i].particle1 + 1 + (int)value2;
+      if ((i > 0) && (compareBonds(&bondStates[i - 1], &bondStates[i]) >= 0))
+      {
+         return(false);
+      }
+      last = bondStates[i].particle1;
+      numBondStates++;
+   }
+   return(true);
+}
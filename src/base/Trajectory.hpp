@@ -0,0 +1,193 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Trajectory.
+ * A recording of the particles and bonds of a world after each morph,
+ * written as a binary stream of frames. A keyframe holds the whole
+ * world; a delta frame holds only the changes since the previous frame.
+ * A keyframe is written every key interval frames, so that a frame can
+ * be played by skipping to the keyframe before it.
+ *
+ * The stream is a header, frames and an end frame. Each frame is a
+ * frame header followed by values encoded as variable-length integers
+ * (signed values zigzag encoded). Particles are in world order, and
+ * positions are in fixed point with TRAJECTORY_SCALE units per cell.
+ *
+ * Keyframe: the number of particles, then each particle's type,
+ * orientation index and position; the number of bonds, then each
+ * bond as frame indices of its particles.
+ *
+ * Delta frame: the number of particles, then for each particle a
+ * flags byte. A NEW_PARTICLE is followed by its type, orientation and
+ * position. A particle continuing from the previous frame is followed
+ * by its previous frame index offset (unless NEXT_PARTICLE: it is the
+ * one after the preceding continuing particle), then by its changed
+ * type, orientation and position delta. Previous frame particles that
+ * do not continue are gone, with their bonds. Then come the removed
+ * bonds between continuing particles and the added bonds.
+ *
+ * Particles are identified between frames by address.
+ */
+
+#ifndef __TRAJECTORY__
+#define __TRAJECTORY__
+
+#include <stdio.h>
+#include "Parameters.h"
+
+class Mechanics;
+class Particle;
+
+// Trajectory format.
+#define TRAJECTORY_MAGIC      "MAXTRAJ"
+#define TRAJECTORY_VERSION    1
+#define TRAJECTORY_SCALE      1024 // position units per cell
+
+class Trajectory
+{
+public:
+
+   // Recorded particle.
+   struct ParticleState
+   {
+      int type;
+      int orientation;
+      int x, y;
+   };
+
+   // Recorded bond: frame indices of particles (particle1 < particle2).
+   struct BondState
+   {
+      int particle1;
+      int particle2;
+   };
+
+   // Trajectory valid (when playing, header was readable)?
+   bool valid;
+
+   // Frame last recorded or played.
+   int           step;
+   int           numParticles;
+   ParticleState *particles;
+   int           numBonds;
+   BondState     *bonds;
+
+   // Constructor: record to file with keyframe interval (0 = first
+   // frame only), or play from file (keyInterval ignored).
+   Trajectory(FILE *fp, bool record, int keyInterval = 0);
+
+   // Destructor: a recording is ended.
+   ~Trajectory();
+
+   // Record frame of world.
+   void record(Mechanics *mechanics);
+
+   // Play next frame (false if none).
+   bool play();
+
+   // Play frame of given step (false if none).
+   // Playing can continue from the frame found.
+   bool seek(int step);
+
+private:
+
+   // Stream header.
+   struct Header
+   {
+      char magic[8];
+      int  version;
+      int  width;
+      int  height;
+      int  scale;
+      int  keyInterval;
+   };
+
+   // Frame header: frame type, step and encoded length.
+   struct FrameHeader
+   {
+      int type;
+      int step;
+      int length;
+   };
+
+   // Frame types.
+   enum { END_FRAME = 0, KEY_FRAME = 1, DELTA_FRAME = 2 };
+
+   // Delta frame particle flags.
+   enum
+   {
+      NEW_PARTICLE        = 0x01,
+      NEXT_PARTICLE       = 0x02,
+      TYPE_CHANGED        = 0x04,
+      ORIENTATION_CHANGED = 0x08,
+      MOVED               = 0x10
+   };
+
+   // Particle with its frame index.
+   struct ParticleIndex
+   {
+      Particle *particle;
+      int      index;
+   };
+
+   FILE *fp;
+   bool recording;
+   bool ended;
+   int  keyInterval;
+   long start;
+
+   // Recorded particles sorted by address.
+   ParticleIndex *particleIndex;
+
+   // Encoded frame.
+   unsigned char *buffer;
+   int           bufferSize;
+   int           length;
+   int           position;
+
+   // Record and play frames.
+   void recordKey(ParticleState *states, int numStates,
+                  BondState *bondStates, int numBondStates);
+   void recordDelta(ParticleState *states, int numStates,
+                    ParticleIndex *index, BondState *bondStates,
+                    int numBondStates);
+   bool playKey();
+   bool playDelta();
+
+   // Find bonds of recorded particles, in index order.
+   static int findBonds(ParticleIndex *index, int numIndex,
+                        BondState *& bondStates);
+
+   // Encode and decode values.
+   void reserve(int size);
+   void putValue(unsigned int value);
+   void putSigned(int value);
+   void putParticle(ParticleState *state);
+   void putBonds(BondState *bondStates, int numBondStates);
+   void write(int type);
+   bool getValue(unsigned int& value);
+   bool getSigned(int& value);
+   bool getParticle(ParticleState *state);
+   bool getBonds(BondState *& bondStates, int& numBondStates,
+                 int numStates);
+
+   // Map bonds of previous frame particles to their current frame
+   // indices, dropping bonds of particles that are gone.
+   static int mapBonds(BondState *bondStates, int numBondStates,
+                       int *mapping, BondState *& mappedStates);
+};
+#endif
@@ -0,0 +1,1387 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Evaluate population members: pending evaluation jobs are evaluated
+ * by farm workers, from the worlds loaded for the generation (threaded
+ * and racing evaluation), in forked processes or in order.
+ */
+
+#ifdef UNIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <pthread.h>
+#endif
+#include <time.h>
+#include <assert.h>
+#include "Evaluate.hpp"
+
+// Generation seeds.
+long EvaluationSeeds[EVALUATION_SEEDS];
+
+// Evaluation, by job.
+int    EvaluationSources[EVALUATION_JOBS];
+bool   EvaluationPending[EVALUATION_JOBS];
+double EvaluationFitnesses[EVALUATION_JOBS];
+int    EvaluationCycles[EVALUATION_JOBS];
+#if (TRACE_GENES == 1)
+bool EvaluationFired[EVALUATION_JOBS][NUM_GENES];
+#endif
+#if (RACE_EVALUATION == 1)
+bool EvaluationRaced[EVALUATION_JOBS];
+#endif
+
+#if (EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+// Fitness of least fit elite member.
+double EliteCutoff;
+#endif
+
+// Get evaluation result of morphogen morphed for cycles.
+void getEvaluationResult(MORPHOGEN *morphogen, int cycles,
+                         EvaluationResult *result);
+
+// Evaluate jobs in order.
+void evaluateSerial();
+
+#if (THREAD_EVALUATION == 1 || RACE_EVALUATION == 1)
+// Evaluation of jobs from the worlds loaded for a generation.
+struct Evaluation;
+
+// Automata of jobs being morphed.
+Automaton *EvaluationAutomata[EVALUATION_JOBS];
+
+// Start evaluation: load worlds for seeds of pending jobs.
+Evaluation *startEvaluation();
+
+// Morph pending jobs up to horizon.
+void runEvaluation(Evaluation *evaluation, int horizon);
+
+// Finish evaluation.
+void finishEvaluation(Evaluation *evaluation);
+
+// Morph job up to horizon; true when its evaluation is done.
+bool morphJob(int job, Evaluation *evaluation, int horizon);
+
+// Finish job: record its evaluation from its automaton.
+void finishJob(int job);
+
+// Evaluate jobs from the worlds loaded for the generation.
+void evaluateWorlds();
+#endif
+
+#if (RACE_EVALUATION == 1)
+// Race out evaluation jobs of members that cannot survive pruning.
+void raceJobs();
+#endif
+
+#if (FORK_EVALUATION == 1)
+// Evaluate jobs in forked processes.
+void evaluateForked();
+#endif
+
+#if (FARM_EVALUATION == 1)
+// Farm socket name, coordinator listening socket (-1 if not
+// coordinating) and test body file text sent to workers.
+char *FarmSocketName;
+int  FarmListener = -1;
+char *FarmBodies;
+int  FarmBodiesLength;
+
+// Farm evaluation stamp: results of jobs sent for an earlier
+// evaluation are discarded.
+int FarmStamp;
+
+// Farm job message: evaluation stamp and job, its seed and member
+// genome. (Coordinator and workers run the same program on the same
+// host.)
+struct FarmJob
+{
+   int          stamp;
+   int          job;
+   long         seed;
+   Gene::Packed genes[NUM_GENES];
+};
+
+// Farm result message.
+struct FarmResult
+{
+   int              stamp;
+   int              job;
+   EvaluationResult evaluation;
+};
+
+// Farm worker connection: socket, stamp and job being evaluated
+// (-1 if idle) and time it was sent.
+struct FarmWorker
+{
+   int    socket;
+   int    stamp;
+   int    job;
+   time_t sent;
+};
+FarmWorker FarmWorkers[MAX_FARM_WORKERS];
+int        NumFarmWorkers;
+
+// Accept farm worker connection.
+void acceptFarmWorker();
+
+// Close farm worker connection.
+void closeFarmWorker(int workerIndex, int *dispatches);
+
+// Evaluate jobs by farm workers.
+void evaluateFarmed();
+
+// Send and receive farm messages.
+bool sendFarm(int socket, void *buf, int length);
+bool receiveFarm(int socket, void *buf, int length);
+#endif
+
+#if (EARLY_TERMINATION == 1)
+// Termination test: can evaluation of member in automaton stop?
+typedef bool (*TerminationTest)(Automaton *automaton, Member *member);
+
+// Termination tests.
+bool organismLost(Automaton *, Member *);
+#if (TERMINATE_BELOW_ELITE == 1)
+bool belowElite(Automaton *, Member *);
+#endif
+
+// Tests applied during evaluation (NULL-terminated).
+TerminationTest TerminationTests[] =
+{
+   organismLost,
+#if (TERMINATE_BELOW_ELITE == 1)
+   belowElite,
+#endif
+   NULL
+};
+#endif
+
+#if (EARLY_TERMINATION == 1 || RACE_EVALUATION == 1)
+// Count particles of given type.
+int countParticles(Automaton *automaton, int type);
+
+// Bound fitness of organism in automaton.
+bool boundFitness(Automaton *automaton, double& bound);
+#endif
+
+// Evaluate pending jobs. A farm evaluates them if there is one;
+// otherwise, unless in display mode, they are evaluated from the
+// loaded worlds if threaded or racing, else in forked processes
+// if forking, else in order.
+void evaluatePending()
+{
+   int job;
+
+   for (job = 0; (job < EVALUATION_JOBS) && !EvaluationPending[job]; job++)
+   {
+   }
+   if (job == EVALUATION_JOBS)
+   {
+      return;
+   }
+
+#if (FARM_EVALUATION == 1)
+   if (FarmListener != -1)
+   {
+      evaluateFarmed();
+   }
+   else
+#endif
+   if (!Display)
+   {
+#if (THREAD_EVALUATION == 1 || RACE_EVALUATION == 1)
+      evaluateWorlds();
+#elif (FORK_EVALUATION == 1)
+      evaluateForked();
+#else
+      evaluateSerial();
+#endif
+   }
+   else
+   {
+      evaluateSerial();
+   }
+
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      EvaluationPending[job] = false;
+   }
+}
+
+
+// Record evaluation result of job. The job is no longer pending.
+void recordEvaluation(int job, EvaluationResult *result)
+{
+   EvaluationFitnesses[job] = result->fitness;
+   EvaluationCycles[job]    = result->cycles;
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      EvaluationFired[job][i] = result->fired[i];
+   }
+#endif
+   EvaluationPending[job] = false;
+}
+
+
+// Get evaluation result of morphogen morphed for cycles.
+void getEvaluationResult(MORPHOGEN *morphogen, int cycles,
+                         EvaluationResult *result)
+{
+   result->fitness = morphogen->getFitness();
+   result->cycles  = cycles;
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      result->fired[i] = morphogen->geneFired[i];
+   }
+#endif
+}
+
+
+// Evaluate jobs in order.
+void evaluateSerial()
+{
+   int              j, job, seedIndex;
+   Member           *member;
+   Random           streams;
+   EvaluationResult result;
+
+#if (CLONE_WORLD == 1)
+   Snapshot *world = NULL;
+#endif
+
+   for (job = 0, seedIndex = -1; job < EVALUATION_JOBS; job++)
+   {
+      if (!EvaluationPending[job])
+      {
+         continue;
+      }
+
+      // Random number streams of seed.
+      if (JOB_SEED(job) != seedIndex)
+      {
+         seedIndex = JOB_SEED(job);
+         streams.setRand(EvaluationSeeds[seedIndex]);
+#if (CLONE_WORLD == 1)
+         delete world;
+         world = NULL;
+#endif
+      }
+
+      // Install member genome.
+      member = Population[JOB_MEMBER(job)];
+
+      // Create automaton containing morphogen.
+      delete automaton;
+      automaton = new Automaton();
+      assert(automaton != NULL);
+      morphogen = &automaton->morphogen;
+
+      // Load member genome into morphogen.
+      morphogen->setGenome(member->genome->duplicate());
+
+#if (CLONE_WORLD == 1)
+      // Restore world loaded for first member.
+      if (world != NULL)
+      {
+         automaton->restore(world);
+      }
+      else
+      {
+#endif
+
+      // Load test bodies into morphogen.
+      automaton->mechanics.random = streams.split(LOAD_STREAM);
+      if (!morphogen->load(TestBodies, NumTestBodies))
+      {
+         Log::logError("Cannot load morphogen");
+         exit(1);
+      }
+
+#if (CLONE_WORLD == 1)
+         world = automaton->snapshot();
+      }
+#endif
+
+      // Morph with member random numbers.
+      automaton->mechanics.random = streams.split(MEMBER_STREAM);
+
+#if (FORAGE_EVOLVE == 1 && FORAGING_MOVEMENT_SCREEN == 1)
+      if (morphogen->isMobile(21) ||
+          morphogen->isMobile(22) ||
+          morphogen->isMobile(23))
+      {
+         MobileFound       = true;
+         Log::LOGGING_FLAG = EVOLVE_LOGGING;
+#endif
+
+      // Morph.
+      for (j = 0; j < MORPH_CYCLES; j++)
+      {
+         automaton->morph();
+
+         // Display?
+         if (Display)
+         {
+            display();
+         }
+
+#if (EARLY_TERMINATION == 1)
+         // Evaluation hopeless?
+         if ((((j + 1) % TERMINATION_CHECK_CYCLES) == 0) &&
+             terminateEvaluation(automaton, member))
+         {
+            j++;
+            break;
+         }
+#endif
+      }
+
+#if (FORAGE_EVOLVE == 1 && FORAGING_MOVEMENT_SCREEN == 1)
+   }
+   else
+   {
+      j = MORPH_CYCLES;
+      if (Display)
+      {
+         display();
+      }
+   }
+#endif
+
+      // Record evaluation.
+      getEvaluationResult(morphogen, j, &result);
+      recordEvaluation(job, &result);
+   }
+
+#if (CLONE_WORLD == 1)
+   delete world;
+#endif
+}
+
+
+#if (THREAD_EVALUATION == 1 || RACE_EVALUATION == 1)
+// Evaluation of jobs from the worlds loaded for a generation.
+struct Evaluation
+{
+   // Worlds loaded for the generation seeds and their random
+   // number streams.
+   Snapshot *worlds[EVALUATION_SEEDS];
+   Random   streams[EVALUATION_SEEDS];
+
+#if (THREAD_EVALUATION == 1)
+   // Morph horizon and next job to morph.
+   int             horizon;
+   int             next;
+   pthread_mutex_t lock;
+#endif
+};
+
+// Start evaluation: load worlds for seeds of pending jobs.
+Evaluation *startEvaluation()
+{
+   int        i, job;
+   Evaluation *evaluation;
+
+   evaluation = new Evaluation;
+   assert(evaluation != NULL);
+   for (i = 0; i < EVALUATION_SEEDS; i++)
+   {
+      evaluation->worlds[i] = NULL;
+      for (job = i * POPULATION_SIZE;
+           (job < (i + 1) * POPULATION_SIZE) && !EvaluationPending[job]; job++)
+      {
+      }
+      if (job == (i + 1) * POPULATION_SIZE)
+      {
+         continue;
+      }
+      evaluation->streams[i].setRand(EvaluationSeeds[i]);
+      delete automaton;
+      automaton = new Automaton();
+      assert(automaton != NULL);
+      morphogen = &automaton->morphogen;
+      automaton->mechanics.random = evaluation->streams[i].split(LOAD_STREAM);
+      if (!morphogen->load(TestBodies, NumTestBodies))
+      {
+         Log::logError("Cannot load morphogen");
+         exit(1);
+      }
+      evaluation->worlds[i] = automaton->snapshot();
+   }
+#if (THREAD_EVALUATION == 1)
+   pthread_mutex_init(&evaluation->lock, NULL);
+#endif
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      EvaluationAutomata[job] = NULL;
+   }
+   return(evaluation);
+}
+
+
+// Finish evaluation.
+void finishEvaluation(Evaluation *evaluation)
+{
+#if (THREAD_EVALUATION == 1)
+   pthread_mutex_destroy(&evaluation->lock);
+#endif
+   for (int i = 0; i < EVALUATION_SEEDS; i++)
+   {
+      delete evaluation->worlds[i];
+   }
+   delete evaluation;
+}
+
+
+// Morph job up to horizon; true when its evaluation is done.
+// The member is morphed in its own automaton restored from the
+// world of the job's seed.
+bool morphJob(int job, Evaluation *evaluation, int horizon)
+{
+   int       j;
+   bool      done;
+   Automaton *automaton;
+
+   automaton = EvaluationAutomata[job];
+   if (automaton == NULL)
+   {
+      automaton = new Automaton();
+      assert(automaton != NULL);
+      automaton->morphogen.setGenome(Population[JOB_MEMBER(job)]->genome->duplicate());
+      automaton->restore(evaluation->worlds[JOB_SEED(job)]);
+      automaton->mechanics.random =
+         evaluation->streams[JOB_SEED(job)].split(MEMBER_STREAM);
+      EvaluationAutomata[job] = automaton;
+      EvaluationCycles[job]   = 0;
+   }
+   done = false;
+   for (j = EvaluationCycles[job]; (j < horizon) && !done; j++)
+   {
+      automaton->morph();
+#if (EARLY_TERMINATION == 1)
+      if ((((j + 1) % TERMINATION_CHECK_CYCLES) == 0) &&
+          terminateEvaluation(automaton, Population[JOB_MEMBER(job)]))
+      {
+         done = true;
+      }
+#endif
+   }
+   EvaluationCycles[job] = j;
+   if (!done && (j < MORPH_CYCLES))
+   {
+      return(false);
+   }
+   finishJob(job);
+   return(true);
+}
+
+
+// Finish job: record its evaluation from its automaton.
+// The job is no longer pending.
+void finishJob(int job)
+{
+   Automaton        *automaton = EvaluationAutomata[job];
+   EvaluationResult result;
+
+   getEvaluationResult(&automaton->morphogen, EvaluationCycles[job], &result);
+   recordEvaluation(job, &result);
+   delete automaton;
+   EvaluationAutomata[job] = NULL;
+}
+
+
+#if (THREAD_EVALUATION == 1)
+// Evaluation thread: morph jobs until none remain.
+void *evaluationThread(void *arg)
+{
+   Evaluation *evaluation = (Evaluation *)arg;
+   int        job;
+
+   for ( ; ; )
+   {
+      // Take next job to be morphed.
+      pthread_mutex_lock(&evaluation->lock);
+      for (job = evaluation->next;
+           (job < EVALUATION_JOBS) && !EvaluationPending[job]; job++)
+      {
+      }
+      evaluation->next = job + 1;
+      pthread_mutex_unlock(&evaluation->lock);
+      if (job >= EVALUATION_JOBS)
+      {
+         break;
+      }
+      morphJob(job, evaluation, evaluation->horizon);
+   }
+   return(NULL);
+}
+
+
+#endif
+
+// Morph pending jobs up to horizon.
+// Up to EVALUATION_THREADS threads take jobs in order.
+void runEvaluation(Evaluation *evaluation, int horizon)
+{
+#if (THREAD_EVALUATION == 1)
+   int       i, threads;
+   pthread_t threadIds[EVALUATION_JOBS];
+
+   // Determine number of threads.
+   threads = EVALUATION_THREADS;
+   if (threads <= 0)
+   {
+      threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+      if (threads <= 0)
+      {
+         threads = 1;
+      }
+   }
+   if (threads > EVALUATION_JOBS)
+   {
+      threads = EVALUATION_JOBS;
+   }
+
+   // Run evaluation threads.
+   evaluation->horizon = horizon;
+   evaluation->next    = 0;
+   for (i = 0; i < threads; i++)
+   {
+      if (pthread_create(&threadIds[i], NULL, evaluationThread, evaluation) != 0)
+      {
+         Log::logError("Cannot create evaluation thread");
+         exit(1);
+      }
+   }
+   for (i = 0; i < threads; i++)
+   {
+      pthread_join(threadIds[i], NULL);
+   }
+#else
+   for (int job = 0; job < EVALUATION_JOBS; job++)
+   {
+      if (EvaluationPending[job])
+      {
+         morphJob(job, evaluation, horizon);
+      }
+   }
+#endif
+}
+
+
+// Evaluate jobs from the worlds loaded for the generation,
+// in threads if THREAD_EVALUATION. When racing, jobs are morphed
+// in stages, and after each stage those of members that cannot
+// survive pruning are raced out.
+void evaluateWorlds()
+{
+   Evaluation *evaluation;
+
+   evaluation = startEvaluation();
+#if (RACE_EVALUATION == 1)
+   for (int horizon = RACE_HORIZON; horizon < MORPH_CYCLES; horizon *= 2)
+   {
+      runEvaluation(evaluation, horizon);
+      raceJobs();
+   }
+#endif
+   runEvaluation(evaluation, MORPH_CYCLES);
+   finishEvaluation(evaluation);
+}
+
+
+#endif
+
+#if (RACE_EVALUATION == 1)
+// Race out evaluation jobs of members that cannot survive pruning.
+// A member's fitness is bounded below by counting unknown evaluations
+// as zero, and above by counting evaluations being morphed at the
+// fitness bound of their organisms (unbounded if not yet morphed).
+// The cutoff is the least of the FIT_POPULATION_SIZE greatest lower
+// bounds, and a job being morphed is raced out if the upper bound of
+// every member its evaluation applies to is below the cutoff.
+void raceJobs()
+{
+   int    i, j, k, n, job;
+   double lowers[POPULATION_SIZE], uppers[POPULATION_SIZE];
+   double bounds[POPULATION_SIZE], bound, cutoff;
+   bool   bounded[POPULATION_SIZE];
+   Member *member;
+
+   // Bound member fitnesses.
+   for (i = 0; i < POPULATION_SIZE; i++)
+   {
+      lowers[i]  = uppers[i] = 0.0;
+      bounded[i] = true;
+   }
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      i = JOB_MEMBER(job);
+      j = EvaluationSources[job];
+      if (j == -1)
+      {
+         lowers[i] += EvaluationFitnesses[job];
+         uppers[i] += EvaluationFitnesses[job];
+      }
+      else if ((j >= 0) && !EvaluationPending[j])
+      {
+         lowers[i] += EvaluationFitnesses[j];
+         uppers[i] += EvaluationFitnesses[j];
+      }
+      else if ((j >= 0) && (EvaluationAutomata[j] != NULL) &&
+               boundFitness(EvaluationAutomata[j], bound))
+      {
+         uppers[i] += bound;
+      }
+      else
+      {
+         bounded[i] = false;
+      }
+   }
+   for (i = 0; i < POPULATION_SIZE; i++)
+   {
+      member    = Population[i];
+      lowers[i] = ((member->fitness * member->age) +
+                   (lowers[i] / EVALUATION_SEEDS)) / (member->age + 1);
+      uppers[i] = ((member->fitness * member->age) +
+                   (uppers[i] / EVALUATION_SEEDS)) / (member->age + 1);
+   }
+
+   // Find cutoff.
+   for (i = n = 0; i < POPULATION_SIZE; i++)
+   {
+      for (k = n; (k > 0) && (bounds[k - 1] < lowers[i]); k--)
+      {
+         bounds[k] = bounds[k - 1];
+      }
+      bounds[k] = lowers[i];
+      n++;
+   }
+   cutoff = bounds[FIT_POPULATION_SIZE - 1];
+
+   // Race out jobs.
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      if (EvaluationAutomata[job] == NULL)
+      {
+         continue;
+      }
+      for (j = 0; j < EVALUATION_JOBS; j++)
+      {
+         i = JOB_MEMBER(j);
+         if ((EvaluationSources[j] == job) &&
+             (!bounded[i] || (uppers[i] >= cutoff)))
+         {
+            break;
+         }
+      }
+      if (j == EVALUATION_JOBS)
+      {
+         finishJob(job);
+         EvaluationRaced[job] = true;
+      }
+   }
+}
+
+
+#endif
+
+#if (FORK_EVALUATION == 1)
+// Evaluate jobs in forked processes.
+// Jobs are evaluated in order by up to EVALUATION_PROCESSES
+// processes at a time, each inheriting the world of its seed.
+void evaluateForked()
+{
+   int              i, j, job, next, running, processes;
+   int              fds[EVALUATION_JOBS][2];
+   pid_t            pids[EVALUATION_JOBS], pid;
+   Random           streams[EVALUATION_SEEDS];
+   Automaton        *worlds[EVALUATION_SEEDS];
+   EvaluationResult result;
+
+   // Load worlds shared by the jobs of each seed.
+   delete automaton;
+   automaton = NULL;
+   for (i = 0; i < EVALUATION_SEEDS; i++)
+   {
+      worlds[i] = NULL;
+      for (job = i * POPULATION_SIZE;
+           (job < (i + 1) * POPULATION_SIZE) && !EvaluationPending[job]; job++)
+      {
+      }
+      if (job == (i + 1) * POPULATION_SIZE)
+      {
+         continue;
+      }
+      streams[i].setRand(EvaluationSeeds[i]);
+      worlds[i] = new Automaton();
+      assert(worlds[i] != NULL);
+      worlds[i]->mechanics.random = streams[i].split(LOAD_STREAM);
+      if (!worlds[i]->morphogen.load(TestBodies, NumTestBodies))
+      {
+         Log::logError("Cannot load morphogen");
+         exit(1);
+      }
+   }
+
+   // Determine number of processes.
+   processes = EVALUATION_PROCESSES;
+   if (processes <= 0)
+   {
+      processes = (int)sysconf(_SC_NPROCESSORS_ONLN);
+      if (processes <= 0)
+      {
+         processes = 1;
+      }
+   }
+
+   // Fork job evaluations.
+   fflush(NULL);
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      pids[job] = -1;
+   }
+   for (next = running = 0; (next < EVALUATION_JOBS) || (running > 0); )
+   {
+      if ((next < EVALUATION_JOBS) && !EvaluationPending[next])
+      {
+         next++;
+         continue;
+      }
+      if ((next < EVALUATION_JOBS) && (running < processes))
+      {
+         job = next;
+         next++;
+         if (pipe(fds[job]) == -1)
+         {
+            Log::logError("Cannot create evaluation pipe");
+            exit(1);
+         }
+         pid = fork();
+         if (pid == -1)
+         {
+            Log::logError("Cannot fork evaluation process");
+            exit(1);
+         }
+         if (pid == 0)
+         {
+            // Evaluate member with inherited world.
+            close(fds[job][0]);
+            Log::LOGGING_FLAG = NO_LOG;
+            automaton = worlds[JOB_SEED(job)];
+            morphogen = &automaton->morphogen;
+            morphogen->setGenome(Population[JOB_MEMBER(job)]->genome->duplicate());
+            automaton->mechanics.random = streams[JOB_SEED(job)].split(MEMBER_STREAM);
+            for (j = 0; j < MORPH_CYCLES; j++)
+            {
+               automaton->morph();
+#if (EARLY_TERMINATION == 1)
+               if ((((j + 1) % TERMINATION_CHECK_CYCLES) == 0) &&
+                   terminateEvaluation(automaton, Population[JOB_MEMBER(job)]))
+               {
+                  j++;
+                  break;
+               }
+#endif
+            }
+            getEvaluationResult(morphogen, j, &result);
+            if (write(fds[job][1], &result, sizeof(result)) != sizeof(result))
+            {
+               _exit(1);
+            }
+            _exit(0);
+         }
+         close(fds[job][1]);
+         pids[job] = pid;
+         running++;
+         continue;
+      }
+
+      // Collect result of a finished evaluation.
+      pid = wait(NULL);
+      if (pid == -1)
+      {
+         Log::logError("Cannot wait for evaluation process");
+         exit(1);
+      }
+      for (job = 0; job < next && pids[job] != pid; job++)
+      {
+      }
+      if (job == next)
+      {
+         continue;
+      }
+      if (read(fds[job][0], &result, sizeof(result)) != sizeof(result))
+      {
+         sprintf(Log::messageBuf, "Evaluation process failed for member %d",
+                 JOB_MEMBER(job));
+         Log::logError();
+         exit(1);
+      }
+      close(fds[job][0]);
+      pids[job] = -1;
+      recordEvaluation(job, &result);
+      running--;
+   }
+
+   // Keep last world as the automaton.
+   for (i = 0; i < EVALUATION_SEEDS; i++)
+   {
+      if (worlds[i] != NULL)
+      {
+         delete automaton;
+         automaton = worlds[i];
+         morphogen = &automaton->morphogen;
+      }
+   }
+}
+
+
+#endif
+
+
+#if (FARM_EVALUATION == 1)
+// Open farm socket and read test body file text for workers.
+void openFarm(char *socketName, char *bodiesFileName)
+{
+   FILE               *fp;
+   struct sockaddr_un address;
+
+   FarmSocketName = socketName;
+   if ((fp = fopen(bodiesFileName, "rb")) == NULL)
+   {
+      sprintf(Log::messageBuf, "Cannot load test body file %s", bodiesFileName);
+      Log::logError();
+      exit(1);
+   }
+   fseek(fp, 0, SEEK_END);
+   FarmBodiesLength = (int)ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   FarmBodies = new char[FarmBodiesLength + 1];
+   assert(FarmBodies != NULL);
+   FarmBodiesLength = (int)fread(FarmBodies, 1, FarmBodiesLength, fp);
+   FarmBodies[FarmBodiesLength] = '\0';
+   fclose(fp);
+
+   if (strlen(FarmSocketName) >= sizeof(address.sun_path))
+   {
+      sprintf(Log::messageBuf, "Farm socket name too long: %s", FarmSocketName);
+      Log::logError();
+      exit(1);
+   }
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, FarmSocketName);
+   unlink(FarmSocketName);
+   if (((FarmListener = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) ||
+       (bind(FarmListener, (struct sockaddr *)&address, sizeof(address)) == -1) ||
+       (listen(FarmListener, MAX_FARM_WORKERS) == -1))
+   {
+      sprintf(Log::messageBuf, "Cannot open farm socket %s", FarmSocketName);
+      Log::logError();
+      exit(1);
+   }
+   NumFarmWorkers = 0;
+   sprintf(Log::messageBuf, "Farm socket=%s", FarmSocketName);
+   Log::logInformation();
+}
+
+
+// Accept farm worker connection and send it the test bodies.
+void acceptFarmWorker()
+{
+   int socket;
+
+   if ((socket = accept(FarmListener, NULL, NULL)) == -1)
+   {
+      return;
+   }
+   if ((NumFarmWorkers == MAX_FARM_WORKERS) ||
+       !sendFarm(socket, &FarmBodiesLength, sizeof(FarmBodiesLength)) ||
+       !sendFarm(socket, FarmBodies, FarmBodiesLength))
+   {
+      close(socket);
+      return;
+   }
+   FarmWorkers[NumFarmWorkers].socket = socket;
+   FarmWorkers[NumFarmWorkers].job    = -1;
+   NumFarmWorkers++;
+   sprintf(Log::messageBuf, "Farm worker connected, Workers=%d", NumFarmWorkers);
+   Log::logInformation();
+}
+
+
+// Close farm worker connection.
+// Its job, if any, is no longer outstanding with it.
+void closeFarmWorker(int workerIndex, int *dispatches)
+{
+   FarmWorker *worker = &FarmWorkers[workerIndex];
+
+   close(worker->socket);
+   if ((worker->job != -1) && (worker->stamp == FarmStamp))
+   {
+      dispatches[worker->job]--;
+   }
+   NumFarmWorkers--;
+   *worker = FarmWorkers[NumFarmWorkers];
+   sprintf(Log::messageBuf, "Farm worker lost, Workers=%d", NumFarmWorkers);
+   Log::logInformation();
+}
+
+
+// Close farm socket and worker connections.
+void closeFarm()
+{
+   if (FarmListener != -1)
+   {
+      for (int i = 0; i < NumFarmWorkers; i++)
+      {
+         close(FarmWorkers[i].socket);
+      }
+      close(FarmListener);
+      unlink(FarmSocketName);
+      FarmListener = -1;
+   }
+}
+
+
+// Evaluate jobs by farm workers.
+// An idle worker is given the next job not outstanding with a worker,
+// else the oldest job outstanding for FARM_TIMEOUT seconds.
+void evaluateFarmed()
+{
+   int           i, j, job, remaining, resent, polled;
+   int           dispatches[EVALUATION_JOBS];
+   time_t        sent[EVALUATION_JOBS], now;
+   bool          waiting;
+   FarmJob       message;
+   FarmResult    result;
+   struct pollfd fds[MAX_FARM_WORKERS + 1];
+
+   for (job = remaining = 0; job < EVALUATION_JOBS; job++)
+   {
+      dispatches[job] = 0;
+      if (EvaluationPending[job])
+      {
+         remaining++;
+      }
+   }
+   FarmStamp++;
+   resent  = 0;
+   waiting = false;
+   while (remaining > 0)
+   {
+      // Give jobs to idle workers.
+      now = time(NULL);
+      for (i = 0; i < NumFarmWorkers; i++)
+      {
+         if (FarmWorkers[i].job != -1)
+         {
+            continue;
+         }
+         for (job = 0; job < EVALUATION_JOBS; job++)
+         {
+            if (EvaluationPending[job] && (dispatches[job] == 0))
+            {
+               break;
+            }
+         }
+         if (job == EVALUATION_JOBS)
+         {
+            for (j = 0; j < EVALUATION_JOBS; j++)
+            {
+               if (EvaluationPending[j] && (now - sent[j] >= FARM_TIMEOUT) &&
+                   ((job == EVALUATION_JOBS) || (sent[j] < sent[job])))
+               {
+                  job = j;
+               }
+            }
+            if (job == EVALUATION_JOBS)
+            {
+               break;
+            }
+            resent++;
+         }
+         message.stamp = FarmStamp;
+         message.job   = job;
+         message.seed  = EvaluationSeeds[JOB_SEED(job)];
+         Population[JOB_MEMBER(job)]->genome->pack(message.genes);
+         if (!sendFarm(FarmWorkers[i].socket, &message, sizeof(message)))
+         {
+            closeFarmWorker(i, dispatches);
+            i--;
+            continue;
+         }
+         dispatches[job]++;
+         sent[job]            = now;
+         FarmWorkers[i].stamp = FarmStamp;
+         FarmWorkers[i].job   = job;
+         FarmWorkers[i].sent  = now;
+      }
+      if ((NumFarmWorkers == 0) && !waiting)
+      {
+         Log::logInformation("Waiting for farm workers");
+         waiting = true;
+      }
+
+      // Wait for results and connections.
+      for (i = 0; i < NumFarmWorkers; i++)
+      {
+         fds[i].fd     = FarmWorkers[i].socket;
+         fds[i].events = POLLIN;
+      }
+      fds[i].fd     = FarmListener;
+      fds[i].events = POLLIN;
+      polled        = NumFarmWorkers;
+      if (poll(fds, polled + 1, 1000) == -1)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         Log::logError("Cannot poll farm workers");
+         exit(1);
+      }
+
+      // Collect results, latest workers first so that closed
+      // connections can be replaced by them.
+      for (i = polled - 1; i >= 0; i--)
+      {
+         if (fds[i].revents == 0)
+         {
+            continue;
+         }
+         if (!receiveFarm(FarmWorkers[i].socket, &result, sizeof(result)) ||
+             (result.stamp != FarmWorkers[i].stamp) ||
+             (result.job != FarmWorkers[i].job))
+         {
+            closeFarmWorker(i, dispatches);
+            continue;
+         }
+         FarmWorkers[i].job = -1;
+         if (result.stamp != FarmStamp)
+         {
+            continue;
+         }
+         job = result.job;
+         dispatches[job]--;
+         if (!EvaluationPending[job])
+         {
+            continue;
+         }
+         recordEvaluation(job, &result.evaluation);
+         remaining--;
+      }
+      if (fds[polled].revents != 0)
+      {
+         acceptFarmWorker();
+      }
+   }
+   if (resent > 0)
+   {
+      sprintf(Log::messageBuf, "  Farm jobs resent=%d", resent);
+      Log::logInformation();
+   }
+}
+
+
+// Run as farm worker: evaluate jobs sent by coordinator until it
+// closes the connection. Each job is evaluated in its own automaton
+// restored from the world loaded for its seed, as a threaded
+// evaluation does.
+void runFarmWorker(char *socketName)
+{
+   int                socket, j, length;
+   long               seed;
+   char               *bodies;
+   FILE               *fp;
+   Random             streams;
+   Snapshot           *world;
+   Member             *member;
+   FarmJob            message;
+   FarmResult         result;
+   struct sockaddr_un address;
+
+   // Connect to coordinator.
+   FarmSocketName = socketName;
+   if (strlen(FarmSocketName) >= sizeof(address.sun_path))
+   {
+      sprintf(Log::messageBuf, "Farm socket name too long: %s", FarmSocketName);
+      Log::logError();
+      exit(1);
+   }
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   strcpy(address.sun_path, FarmSocketName);
+   if (((socket = ::socket(AF_UNIX, SOCK_STREAM, 0)) == -1) ||
+       (connect(socket, (struct sockaddr *)&address, sizeof(address)) == -1))
+   {
+      sprintf(Log::messageBuf, "Cannot connect to farm socket %s", FarmSocketName);
+      Log::logError();
+      exit(1);
+   }
+   sprintf(Log::messageBuf, "Farm worker: socket=%s", FarmSocketName);
+   Log::logInformation();
+
+   // Read test bodies.
+   automaton = new Automaton();
+   assert(automaton != NULL);
+   if (!receiveFarm(socket, &length, sizeof(length)) || (length < 0))
+   {
+      Log::logError("Cannot receive farm test bodies");
+      exit(1);
+   }
+   bodies = new char[length + 1];
+   assert(bodies != NULL);
+   if (!receiveFarm(socket, bodies, length))
+   {
+      Log::logError("Cannot receive farm test bodies");
+      exit(1);
+   }
+   bodies[length] = '\0';
+   if ((fp = fmemopen(bodies, length + 1, "r")) == NULL)
+   {
+      Log::logError("Cannot read farm test bodies");
+      exit(1);
+   }
+   readBodies(fp);
+   fclose(fp);
+   delete [] bodies;
+
+   // Evaluate jobs.
+   world = NULL;
+   seed  = 0;
+   while (receiveFarm(socket, &message, sizeof(message)))
+   {
+      // Load world of seed.
+      if ((world == NULL) || (message.seed != seed))
+      {
+         seed = message.seed;
+         streams.setRand(seed);
+         delete world;
+         delete automaton;
+         automaton = new Automaton();
+         assert(automaton != NULL);
+         automaton->mechanics.random = streams.split(LOAD_STREAM);
+         if (!automaton->morphogen.load(TestBodies, NumTestBodies))
+         {
+            Log::logError("Cannot load morphogen");
+            exit(1);
+         }
+         world = automaton->snapshot();
+      }
+
+      // Morph member.
+      member = new Member(Genome::unpack(message.genes));
+      assert(member != NULL);
+      delete automaton;
+      automaton = new Automaton();
+      assert(automaton != NULL);
+      morphogen = &automaton->morphogen;
+      morphogen->setGenome(member->genome->duplicate());
+      automaton->restore(world);
+      automaton->mechanics.random = streams.split(MEMBER_STREAM);
+      for (j = 0; j < MORPH_CYCLES; j++)
+      {
+         automaton->morph();
+#if (EARLY_TERMINATION == 1)
+         if ((((j + 1) % TERMINATION_CHECK_CYCLES) == 0) &&
+             terminateEvaluation(automaton, member))
+         {
+            j++;
+            break;
+         }
+#endif
+      }
+      delete member;
+
+      // Return result.
+      result.stamp = message.stamp;
+      result.job   = message.job;
+      getEvaluationResult(morphogen, j, &result.evaluation);
+      if (!sendFarm(socket, &result, sizeof(result)))
+      {
+         break;
+      }
+   }
+   delete world;
+   close(socket);
+   terminate(0);
+}
+
+
+// Send farm message.
+bool sendFarm(int socket, void *buf, int length)
+{
+   int  n;
+   char *p = (char *)buf;
+
+   while (length > 0)
+   {
+      if ((n = (int)send(socket, p, length, MSG_NOSIGNAL)) <= 0)
+      {
+         if ((n == -1) && (errno == EINTR))
+         {
+            continue;
+         }
+         return(false);
+      }
+      p      += n;
+      length -= n;
+   }
+   return(true);
+}
+
+
+// Receive farm message.
+bool receiveFarm(int socket, void *buf, int length)
+{
+   int  n;
+   char *p = (char *)buf;
+
+   while (length > 0)
+   {
+      if ((n = (int)recv(socket, p, length, 0)) <= 0)
+      {
+         if ((n == -1) && (errno == EINTR))
+         {
+            continue;
+         }
+         return(false);
+      }
+      p      += n;
+      length -= n;
+   }
+   return(true);
+}
+
+
+#endif
+
+
+#if (EARLY_TERMINATION == 1)
+// Terminate evaluation of member?
+bool terminateEvaluation(Automaton *automaton, Member *member)
+{
+   for (int i = 0; TerminationTests[i] != NULL; i++)
+   {
+      if (TerminationTests[i](automaton, member))
+      {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+
+// Organism has lost all its body particles, and the genome cannot
+// make more, so that no Maxwell can be found again.
+// (An organism out of energy is not ended: a body split off it, by a
+// gene or by a bond breaking, starts with INITIAL_ENERGY and may become
+// the organism.)
+bool organismLost(Automaton *automaton, Member *)
+{
+   return((countParticles(automaton, BODY_CORNER_TYPE) == 0) &&
+          (countParticles(automaton, BODY_SIDE_TYPE) == 0) &&
+          !automaton->morphogen.makesBody());
+}
+
+
+#if (TERMINATE_BELOW_ELITE == 1)
+// Member cannot reach elite fitness even if the organism
+// were to digest all remaining food.
+bool belowElite(Automaton *automaton, Member *member)
+{
+   double bound;
+
+   if (!boundFitness(automaton, bound))
+   {
+      return(false);
+   }
+   bound = ((member->fitness * member->age) + bound) / (member->age + 1);
+   return(bound < EliteCutoff);
+}
+
+
+#endif
+#endif
+
+#if (EARLY_TERMINATION == 1 || RACE_EVALUATION == 1)
+// Count particles of given type.
+int countParticles(Automaton *automaton, int type)
+{
+   int      count;
+   Body     *body;
+   Particle *particle;
+
+   count = 0;
+   for (body = automaton->mechanics.bodies; body != NULL; body = body->next)
+   {
+      for (particle = body->particles; particle != NULL;
+           particle = particle->next)
+      {
+         if (particle->type == type)
+         {
+            count++;
+         }
+      }
+   }
+   return(count);
+}
+
+
+// Bound fitness of organism in automaton: the energy of a body if it
+// were to digest all remaining food. Any body may become the organism,
+// and bodies split off or created start with INITIAL_ENERGY, so the
+// greatest of these energies is taken. False if energy is unbounded:
+// a body has infinite energy or the genome can make food.
+bool boundFitness(Automaton *automaton, double& bound)
+{
+   Body *body;
+
+   if (automaton->morphogen.makesFood())
+   {
+      return(false);
+   }
+   bound = (double)INITIAL_ENERGY;
+   for (body = automaton->mechanics.bodies; body != NULL; body = body->next)
+   {
+      if (body->energy == INFINITE_ENERGY)
+      {
+         return(false);
+      }
+      if ((double)body->energy > bound)
+      {
+         bound = (double)body->energy;
+      }
+   }
+   bound += (double)((countParticles(automaton, FOOD_TYPE) +
+                      countParticles(automaton, DIGESTING_FOOD_TYPE) +
+                      countParticles(automaton, DIGESTED_FOOD_TYPE)) * FOOD_PARTICLE_ENERGY);
+   return(true);
+}
+#endif
@@ -0,0 +1,93 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Evaluation of population members. Evolution marks the evaluation
+ * jobs pending and evaluatePending() evaluates them by farm workers,
+ * from worlds loaded for the generation (threaded and racing), in
+ * forked processes or in order. Every evaluator records its results
+ * through recordEvaluation().
+ */
+
+#ifndef __EVALUATE__
+#define __EVALUATE__
+
+#include "Evolve.hpp"
+
+// Generation evaluation: every member is evaluated with each of the
+// generation seeds. An evaluation job is a member evaluated with a seed.
+#define EVALUATION_JOBS        (EVALUATION_SEEDS * POPULATION_SIZE)
+#define JOB_MEMBER(job)        ((job) % POPULATION_SIZE)
+#define JOB_SEED(job)          ((job) / POPULATION_SIZE)
+
+// Generation seeds.
+extern long EvaluationSeeds[EVALUATION_SEEDS];
+
+// Evaluation, by job: job whose evaluation applies (-1 if cached,
+// DEFERRED_EVALUATION if not yet known), whether pending evaluation,
+// fitness and cycles morphed.
+#define DEFERRED_EVALUATION    (-2)
+extern int    EvaluationSources[EVALUATION_JOBS];
+extern bool   EvaluationPending[EVALUATION_JOBS];
+extern double EvaluationFitnesses[EVALUATION_JOBS];
+extern int    EvaluationCycles[EVALUATION_JOBS];
+#if (TRACE_GENES == 1)
+extern bool EvaluationFired[EVALUATION_JOBS][NUM_GENES];
+#endif
+#if (RACE_EVALUATION == 1)
+extern bool EvaluationRaced[EVALUATION_JOBS];
+#endif
+
+#if (EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+// Fitness of least fit elite member.
+extern double EliteCutoff;
+#endif
+
+// Evaluation result: fitness, cycles morphed and genes fired.
+struct EvaluationResult
+{
+   double fitness;
+   int    cycles;
+#if (TRACE_GENES == 1)
+   bool   fired[NUM_GENES];
+#endif
+};
+
+// Evaluate pending jobs. A farm evaluates them if there is one;
+// otherwise, unless in display mode, they are evaluated from the
+// loaded worlds if threaded or racing, else in forked processes
+// if forking, else in order.
+void evaluatePending();
+
+// Record evaluation result of job. The job is no longer pending.
+void recordEvaluation(int job, EvaluationResult *result);
+
+#if (EARLY_TERMINATION == 1)
+// Terminate evaluation of member?
+bool terminateEvaluation(Automaton *automaton, Member *member);
+#endif
+
+#if (FARM_EVALUATION == 1)
+// Open farm socket and read test body file text for workers.
+void openFarm(char *socketName, char *bodiesFileName);
+
+// Close farm socket and worker connections.
+void closeFarm();
+
+// Run as farm worker: evaluate jobs sent by coordinator.
+void runFarmWorker(char *socketName);
+#endif
+#endif
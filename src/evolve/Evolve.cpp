@@ -23,25 +23,38 @@
  *    -output <evolution output file name>
  *    [-logfile <log file name>]
  *    [-display]
+ *    [-island <island number> -islands <number of islands>
+ *     -migrations <migration directory name>]
+ *    [-farm <farm socket name>]
+ *    [-record <trajectory file name>]
+ *    [-seed <random seed> (for a repeatable run)]
+ *
+ * Farm worker usage:
+ * Evolve -worker <farm socket name> [-logfile <log file name>]
  */
 
 #ifdef WIN32
 #include <windows.h>
+#if (defined(_MSC_VER) && (_MSC_VER < 1900))
+#define snprintf    _snprintf
+#endif
 #endif
 #ifdef UNIX
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #endif
 #include <time.h>
 #include <assert.h>
 #include <glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
-#include "../base/Parameters.h"
-#include "../base/Automaton.hpp"
-#include "../util/Log.hpp"
+#include "Evolve.hpp"
+#include "Evaluate.hpp"
 
 // Use test genome.
 #define TEST_GENOME    1
@@ -59,31 +72,22 @@
 #endif
 #endif
 
-// Evolution parameters.
-#define FIT_POPULATION_SIZE    10
-#define NUM_MUTANTS            8
-#define NUM_OFFSPRING          2
-#define POPULATION_SIZE        (FIT_POPULATION_SIZE + NUM_MUTANTS + NUM_OFFSPRING)
-#define MUTATION_RATE          0.1
-#define MORPH_CYCLES           1000
-#define EVOLVE_LOGGING         LOG_TO_BOTH
-
-// Evolve food foraging.
-#define FORAGE_EVOLVE          1
-
-// Foraging hill-climbing optimization of selected values.
-#define FORAGING_HILL_CLIMB    0
-
 #if (FORAGING_MOVEMENT_SCREEN == 1)
 bool MobileFound = false;
 #endif
 
 // Usage.
-char *Usage = "Evolve -cycles <evolution cycles> -bodies <test body input file name>\n \t[-input <evolution input file name> (for run continuation)]\n \t-output <evolution output file name>\n\t[-logfile <log file name>]\n\t[-display]";
+char *Usage = "Evolve -cycles <evolution cycles> -bodies <test body input file name>\n \t[-input <evolution input file name> (for run continuation)]\n \t-output <evolution output file name>\n\t[-logfile <log file name>]\n\t[-display]\n\t[-island <island number> -islands <number of islands>\n\t -migrations <migration directory name>]\n\t[-farm <farm socket name>]\n\t[-record <trajectory file name>]\n\t[-seed <random seed> (for a repeatable run)]\nFarm worker: Evolve -worker <farm socket name> [-logfile <log file name>]";
 
 // Automaton.
 Automaton *automaton;
 
+// Evolution random numbers: generation seeds, mutation and mating.
+Random EvolveRandom;
+
+// Evolution random seed (-1 if seeded from the time).
+long RandomSeed = -1;
+
 // Morphogen.
 MORPHOGEN *morphogen;
 
@@ -99,38 +103,19 @@ int CycleCount;
 char *InputFileName;
 char *OutputFileName;
 
-// Population member.
-class Member
-{
-public:
-
-   Genome *genome;
-   double fitness;
-   int    age;
-
-   // Constructors.
-   Member(Genome *genome)
-   {
-      this->genome = genome;
-      fitness      = 0.0;
-      age          = 0;
-   }
-
-
-   Member(Genome *genome, double fitness, int age)
-   {
-      this->genome  = genome;
-      this->fitness = fitness;
-      this->age     = age;
-   }
-
+// Island number (-1 if none), number of islands, migration directory
+// and stamps of the latest published and taken migrations.
+int  Island = -1;
+int  NumIslands;
+char *MigrationDirectory;
+int  EmigrationStamp;
+int  ImmigrationStamp = -1;
 
-   // Destructor.
-   ~Member()
-   {
-      delete genome;
-   }
-};
+// Trajectory file name, and genome hash of the member last
+// recorded, if any.
+char        *TrajectoryFileName;
+bool        TrajectoryRecorded;
+GENOME_HASH TrajectoryHash;
 
 // Population.
 Member *Population[POPULATION_SIZE];
@@ -140,11 +125,90 @@ void logParameters();
 void loadBodies(char *fileName);
 void loadPopulation(char *fileName);
 void savePopulation(char *fileName);
-void terminate(int);
+
+#if (BINARY_POPULATION == 1)
+// Population checkpoint header.
+struct PopulationHeader
+{
+   char        magic[8];
+   int         version;
+   int         populationSize;
+   int         numGenes;
+   int         recordSize;
+   GENOME_HASH checksum;                          // of records
+};
+
+// Population checkpoint member record.
+struct PopulationRecord
+{
+   double       fitness;
+   int          age;
+   Gene::Packed genes[NUM_GENES];
+};
+
+// Load population checkpoint: false if file is not a checkpoint.
+bool loadCheckpoint(char *fileName);
+
+// Save population checkpoint.
+void saveCheckpoint(char *fileName);
+
+// Checksum population checkpoint records.
+GENOME_HASH checksumRecords(PopulationRecord *records, int numRecords);
+#endif
 
 // Evolve functions.
 void evolve(), evaluate(), prune(), mutate(), mate();
 
+// Migrate genomes between islands.
+void migrate();
+
+// Get name of island migration file.
+void getMigrationFileName(int island, char *suffix, char *fileName);
+
+// Record trajectory of fittest member.
+void recordElite();
+
+// Member genome hashes.
+GENOME_HASH EvaluationHashes[POPULATION_SIZE];
+
+// Apply evaluations of source jobs.
+void applySources();
+
+// Accumulate member evaluation fitness.
+void accumulateFitness(int memberIndex);
+
+#if (FITNESS_CACHE == 1)
+// Fitness cache entry: the genome is retained so that a hash
+// collision is not taken for a match.
+struct FitnessMemo
+{
+   bool        valid;
+   GENOME_HASH hash;
+   Genome      *genome;
+   long        seed;
+   double      fitness;
+   int         cycles;
+#if (TRACE_GENES == 1)
+   bool fired[NUM_GENES];
+#endif
+};
+FitnessMemo FitnessCache[FITNESS_CACHE_SIZE];
+
+// Get cache entry for genome hash and seed.
+FitnessMemo *getFitnessMemo(GENOME_HASH hash, long seed);
+
+// Get cached evaluation of job.
+bool getCachedEvaluation(int job);
+
+// Cache evaluation of job.
+void cacheEvaluation(int job);
+#endif
+
+#if (NEUTRAL_VARIANTS == 1)
+// Is member of job a neutral variant of parent for the job's seed?
+bool isNeutralVariant(int job, int parentIndex);
+#endif
+
 // Display mode?
 bool Display = false;
 
@@ -191,6 +255,10 @@ int main(int argc, char *argv[])
    // Parse arguments.
    char *bodiesFileName = NULL;
    InputFileName = OutputFileName = NULL;
+#if (FARM_EVALUATION == 1)
+   char *farmSocketName = NULL;
+   bool farmWorker      = false;
+#endif
 
    for (int i = 1; i < argc; i++)
    {
@@ -241,11 +309,76 @@ int main(int argc, char *argv[])
          continue;
       }
 
+      if (strcmp(argv[i], "-island") == 0)
+      {
+         i++;
+         Island = atoi(argv[i]);
+         continue;
+      }
+
+      if (strcmp(argv[i], "-islands") == 0)
+      {
+         i++;
+         NumIslands = atoi(argv[i]);
+         continue;
+      }
+
+      if (strcmp(argv[i], "-migrations") == 0)
+      {
+         i++;
+         MigrationDirectory = argv[i];
+         continue;
+      }
+
+      if (strcmp(argv[i], "-seed") == 0)
+      {
+         i++;
+         RandomSeed = atol(argv[i]);
+         if (RandomSeed < 0)
+         {
+            sprintf(Log::messageBuf, "%s: invalid seed", argv[0]);
+            Log::logError();
+            exit(1);
+         }
+         continue;
+      }
+
+      if (strcmp(argv[i], "-record") == 0)
+      {
+         i++;
+         TrajectoryFileName = argv[i];
+         continue;
+      }
+
+#if (FARM_EVALUATION == 1)
+      if (strcmp(argv[i], "-farm") == 0)
+      {
+         i++;
+         farmSocketName = argv[i];
+         continue;
+      }
+
+      if (strcmp(argv[i], "-worker") == 0)
+      {
+         i++;
+         farmSocketName = argv[i];
+         farmWorker     = true;
+         continue;
+      }
+#endif
+
       sprintf(Log::messageBuf, "\nUsage: %s", Usage);
       Log::logError();
       exit(1);
    }
 
+#if (FARM_EVALUATION == 1)
+   if (farmWorker)
+   {
+      runFarmWorker(farmSocketName);
+   }
+#endif
+
    if ((bodiesFileName == NULL) || (OutputFileName == NULL))
    {
       sprintf(Log::messageBuf, "\nUsage: %s", Usage);
@@ -253,6 +386,20 @@ int main(int argc, char *argv[])
       exit(1);
    }
 
+   if ((Island != -1) &&
+       ((Island < 0) || (Island >= NumIslands) || (MigrationDirectory == NULL)))
+   {
+      sprintf(Log::messageBuf, "%s: invalid island", argv[0]);
+      Log::logError();
+      exit(1);
+   }
+   if ((Island != -1) && (strlen(MigrationDirectory) >= BUFSIZ - 32))
+   {
+      sprintf(Log::messageBuf, "%s: migration directory name too long", argv[0]);
+      Log::logError();
+      exit(1);
+   }
+
    if (InputFileName == NULL)
    {
       sprintf(Log::messageBuf, "Initializing evolve: cycles=%d bodies=%s output=%s",
@@ -265,8 +412,27 @@ int main(int argc, char *argv[])
    }
    Log::logInformation();
 
+   if (Island != -1)
+   {
+      snprintf(Log::messageBuf, sizeof(Log::messageBuf),
+               "Island=%d of %d, migrations=%s",
+               Island, NumIslands, MigrationDirectory);
+      Log::logInformation();
+   }
+
    // Seed random numbers.
-   Random::setRand(time(NULL));
+   if (RandomSeed == -1)
+   {
+      RandomSeed = (long)time(NULL);
+   }
+   sprintf(Log::messageBuf, "Seed=%ld", RandomSeed);
+   Log::logInformation();
+   EvolveRandom.setRand(RandomSeed);
+   if (Island != -1)
+   {
+      // Islands started together evolve differently.
+      EvolveRandom = EvolveRandom.split(Island);
+   }
 
    // Create automaton containing morphogen.
    automaton = new Automaton();
@@ -279,16 +445,24 @@ int main(int argc, char *argv[])
    // Load test bodies.
    loadBodies(bodiesFileName);
 
+#if (FARM_EVALUATION == 1)
+   // Open farm for workers.
+   if ((farmSocketName != NULL) && !Display)
+   {
+      openFarm(farmSocketName, bodiesFileName);
+   }
+#endif
+
    // Load population.
    if (InputFileName == NULL)
    {
       for (int i = 0; i < POPULATION_SIZE; i++)
       {
 #if (TEST_GENOME == 1)
-         Population[i] = new Member(new TestGenome());
+         Population[i] = new Member(new TestGenome(&EvolveRandom));
 #else
          Population[i] = new Member(morphogen->createGenome());
-         Population[i]->genome->randomize();
+         Population[i]->genome->randomize(&EvolveRandom);
 #endif
          assert(Population[i] != NULL);
       }
@@ -360,6 +534,195 @@ int main(int argc, char *argv[])
 }
 
 
+#if (BINARY_POPULATION == 1)
+// Load population checkpoint: false if file is not a checkpoint.
+bool loadCheckpoint(char *fileName)
+{
+   int              i, length;
+   bool             loaded;
+   char             *checkpoint;
+   PopulationHeader *header;
+   PopulationRecord *records;
+
+#ifdef UNIX
+   int         fd;
+   struct stat status;
+
+   if ((fd = open(fileName, O_RDONLY)) == -1)
+   {
+      sprintf(Log::messageBuf, "Cannot load population file %s", fileName);
+      Log::logError();
+      exit(1);
+   }
+   if ((fstat(fd, &status) == -1) || (status.st_size < (off_t)sizeof(PopulationHeader)))
+   {
+      close(fd);
+      return(false);
+   }
+   length     = (int)status.st_size;
+   checkpoint = (char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (checkpoint == (char *)MAP_FAILED)
+   {
+      sprintf(Log::messageBuf, "Cannot map population file %s", fileName);
+      Log::logError();
+      exit(1);
+   }
+#else
+   FILE *fp;
+
+   if ((fp = fopen(fileName, "rb")) == NULL)
+   {
+      sprintf(Log::messageBuf, "Cannot load population file %s", fileName);
+      Log::logError();
+      exit(1);
+   }
+   fseek(fp, 0, SEEK_END);
+   length = (int)ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   if (length < (int)sizeof(PopulationHeader))
+   {
+      fclose(fp);
+      return(false);
+   }
+   checkpoint = new char[length];
+   assert(checkpoint != NULL);
+   length = (int)fread(checkpoint, 1, length, fp);
+   fclose(fp);
+#endif
+
+   loaded  = false;
+   header  = (PopulationHeader *)checkpoint;
+   records = (PopulationRecord *)(checkpoint + sizeof(PopulationHeader));
+   if (strncmp(header->magic, POPULATION_MAGIC, sizeof(header->magic)) == 0)
+   {
+      if ((header->version != POPULATION_VERSION) ||
+          (header->populationSize != POPULATION_SIZE) ||
+          (header->numGenes != NUM_GENES) ||
+          (header->recordSize != (int)sizeof(PopulationRecord)) ||
+          (length != (int)(sizeof(PopulationHeader) +
+                           (POPULATION_SIZE * sizeof(PopulationRecord)))))
+      {
+         sprintf(Log::messageBuf, "Incompatible population file %s", fileName);
+         Log::logError();
+         exit(1);
+      }
+      if (header->checksum != checksumRecords(records, POPULATION_SIZE))
+      {
+         sprintf(Log::messageBuf, "Corrupt population file %s", fileName);
+         Log::logError();
+         exit(1);
+      }
+      for (i = 0; i < POPULATION_SIZE; i++)
+      {
+         Population[i] = new Member(Genome::unpack(records[i].genes),
+                                    records[i].fitness, records[i].age);
+         assert(Population[i] != NULL);
+      }
+      loaded = true;
+   }
+
+#ifdef UNIX
+   munmap(checkpoint, length);
+#else
+   delete [] checkpoint;
+#endif
+   return(loaded);
+}
+
+
+// Save population checkpoint.
+void saveCheckpoint(char *fileName)
+{
+   int              i;
+   char             *tempFileName;
+   FILE             *fp;
+   PopulationHeader header;
+   PopulationRecord *records;
+
+   records = new PopulationRecord[POPULATION_SIZE];
+   assert(records != NULL);
+   memset(records, 0, POPULATION_SIZE * sizeof(PopulationRecord));
+   for (i = 0; i < POPULATION_SIZE; i++)
+   {
+      records[i].fitness = Population[i]->fitness;
+      records[i].age     = Population[i]->age;
+      Population[i]->genome->pack(records[i].genes);
+   }
+   memset(&header, 0, sizeof(header));
+   strncpy(header.magic, POPULATION_MAGIC, sizeof(header.magic));
+   header.version        = POPULATION_VERSION;
+   header.populationSize = POPULATION_SIZE;
+   header.numGenes       = NUM_GENES;
+   header.recordSize     = sizeof(PopulationRecord);
+   header.checksum       = checksumRecords(records, POPULATION_SIZE);
+
+   tempFileName = new char[strlen(fileName) + 5];
+   assert(tempFileName != NULL);
+   sprintf(tempFileName, "%s.tmp", fileName);
+   if ((fp = fopen(tempFileName, "wb")) == NULL)
+   {
+      sprintf(Log::messageBuf, "Cannot save to population file %s", tempFileName);
+      Log::logError();
+      exit(1);
+   }
+
+   // Write and flush to disk before renaming, so that the checkpoint
+   // renamed in place is complete even after a system crash.
+   if ((fwrite(&header, sizeof(header), 1, fp) != 1) ||
+       (fwrite(records, sizeof(PopulationRecord), POPULATION_SIZE, fp) != POPULATION_SIZE) ||
+       (fflush(fp) != 0)
+#ifdef UNIX
+       || (fsync(fileno(fp)) != 0)
+#endif
+       )
+   {
+      fclose(fp);
+      sprintf(Log::messageBuf, "Cannot save to population file %s", tempFileName);
+      Log::logError();
+      exit(1);
+   }
+   if (fclose(fp) != 0)
+   {
+      sprintf(Log::messageBuf, "Cannot save to population file %s", tempFileName);
+      Log::logError();
+      exit(1);
+   }
+#ifdef WIN32
+   remove(fileName);
+#endif
+   if (rename(tempFileName, fileName) != 0)
+   {
+      sprintf(Log::messageBuf, "Cannot save to population file %s", fileName);
+      Log::logError();
+      exit(1);
+   }
+   delete [] tempFileName;
+   delete [] records;
+}
+
+
+// Checksum population checkpoint records (FNV-1a).
+GENOME_HASH checksumRecords(PopulationRecord *records, int numRecords)
+{
+   GENOME_HASH   checksum;
+   unsigned char *b = (unsigned char *)records;
+   int           i, n;
+
+   checksum = 0xCBF29CE484222325ULL;
+   n        = numRecords * sizeof(PopulationRecord);
+   for (i = 0; i < n; i++)
+   {
+      checksum ^= b[i];
+      checksum *= 0x100000001B3ULL;
+   }
+   return(checksum);
+}
+
+
+#endif
+
+
 // Log run parameters.
 void logParameters()
 {
@@ -374,6 +737,12 @@ void logParameters()
    Log::logInformation();
    sprintf(Log::messageBuf, "MORPH_CYCLES = %d", MORPH_CYCLES);
    Log::logInformation();
+   sprintf(Log::messageBuf, "EVALUATION_SEEDS = %d", EVALUATION_SEEDS);
+   Log::logInformation();
+   sprintf(Log::messageBuf, "MIGRATION_INTERVAL = %d", MIGRATION_INTERVAL);
+   Log::logInformation();
+   sprintf(Log::messageBuf, "NUM_MIGRANTS = %d", NUM_MIGRANTS);
+   Log::logInformation();
 #if (TEST_GENOME == 1)
    sprintf(Log::messageBuf, "TEST_GENOME = TRUE");
 #else
@@ -417,6 +786,76 @@ void logParameters()
    sprintf(Log::messageBuf, "FORAGING_HILL_CLIMB = TRUE");
 #else
    sprintf(Log::messageBuf, "FORAGING_HILL_CLIMB = FALSE");
+#endif
+   Log::logInformation();
+#if (CLONE_WORLD == 1)
+   sprintf(Log::messageBuf, "CLONE_WORLD = TRUE");
+#else
+   sprintf(Log::messageBuf, "CLONE_WORLD = FALSE");
+#endif
+   Log::logInformation();
+#if (THREAD_EVALUATION == 1)
+   sprintf(Log::messageBuf, "THREAD_EVALUATION = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "EVALUATION_THREADS = %d", EVALUATION_THREADS);
+#else
+   sprintf(Log::messageBuf, "THREAD_EVALUATION = FALSE");
+#endif
+   Log::logInformation();
+#if (FORK_EVALUATION == 1)
+   sprintf(Log::messageBuf, "FORK_EVALUATION = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "EVALUATION_PROCESSES = %d", EVALUATION_PROCESSES);
+#else
+   sprintf(Log::messageBuf, "FORK_EVALUATION = FALSE");
+#endif
+   Log::logInformation();
+#if (FARM_EVALUATION == 1)
+   sprintf(Log::messageBuf, "FARM_EVALUATION = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "MAX_FARM_WORKERS = %d", MAX_FARM_WORKERS);
+   Log::logInformation();
+   sprintf(Log::messageBuf, "FARM_TIMEOUT = %d", FARM_TIMEOUT);
+#else
+   sprintf(Log::messageBuf, "FARM_EVALUATION = FALSE");
+#endif
+   Log::logInformation();
+   sprintf(Log::messageBuf, "TRAJECTORY_KEY_INTERVAL = %d", TRAJECTORY_KEY_INTERVAL);
+   Log::logInformation();
+#if (FITNESS_CACHE == 1)
+   sprintf(Log::messageBuf, "FITNESS_CACHE = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "FITNESS_CACHE_SIZE = %d", FITNESS_CACHE_SIZE);
+#else
+   sprintf(Log::messageBuf, "FITNESS_CACHE = FALSE");
+#endif
+   Log::logInformation();
+#if (NEUTRAL_VARIANTS == 1)
+   sprintf(Log::messageBuf, "NEUTRAL_VARIANTS = TRUE");
+#else
+   sprintf(Log::messageBuf, "NEUTRAL_VARIANTS = FALSE");
+#endif
+   Log::logInformation();
+#if (RACE_EVALUATION == 1)
+   sprintf(Log::messageBuf, "RACE_EVALUATION = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "RACE_HORIZON = %d", RACE_HORIZON);
+#else
+   sprintf(Log::messageBuf, "RACE_EVALUATION = FALSE");
+#endif
+   Log::logInformation();
+#if (EARLY_TERMINATION == 1)
+   sprintf(Log::messageBuf, "EARLY_TERMINATION = TRUE");
+   Log::logInformation();
+   sprintf(Log::messageBuf, "TERMINATION_CHECK_CYCLES = %d", TERMINATION_CHECK_CYCLES);
+   Log::logInformation();
+#if (TERMINATE_BELOW_ELITE == 1)
+   sprintf(Log::messageBuf, "TERMINATE_BELOW_ELITE = TRUE");
+#else
+   sprintf(Log::messageBuf, "TERMINATE_BELOW_ELITE = FALSE");
+#endif
+#else
+   sprintf(Log::messageBuf, "EARLY_TERMINATION = FALSE");
 #endif
    Log::logInformation();
 
@@ -455,13 +894,26 @@ void loadBodies(char *fileName)
 {
    FILE *fp;
 
-   if ((fp = fopen(fileName, "r")) == NULL)
+   if ((fp = fopen(fileName, "rb")) == NULL)
    {
       sprintf(Log::messageBuf, "Cannot load test body file %s", fileName);
       Log::logError();
       exit(1);
    }
-   fscanf(fp, "%d", &NumTestBodies);
+   readBodies(fp);
+   fclose(fp);
+}
+
+
+// Read test bodies.
+void readBodies(FILE *fp)
+{
+   bool binary = Body::readHeader(fp, NumTestBodies);
+
+   if (!binary)
+   {
+      fscanf(fp, "%d", &NumTestBodies);
+   }
    if (NumTestBodies < 0)
    {
       sprintf(Log::messageBuf, "Invalid number of test bodies: %d", NumTestBodies);
@@ -472,9 +924,21 @@ void loadBodies(char *fileName)
    assert(TestBodies != NULL);
    for (int i = 0; i < NumTestBodies; i++)
    {
-      TestBodies[i] = Body::read(fp, &automaton->mechanics);
+      if (binary)
+      {
+         TestBodies[i] = Body::readBinary(fp, &automaton->mechanics);
+      }
+      else
+      {
+         TestBodies[i] = Body::read(fp, &automaton->mechanics);
+      }
+      if (TestBodies[i] == NULL)
+      {
+         sprintf(Log::messageBuf, "Invalid test body: %d", i);
+         Log::logError();
+         exit(1);
+      }
    }
-   fclose(fp);
 }
 
 
@@ -486,6 +950,13 @@ void loadPopulation(char *fileName)
    double fitness;
    int    age;
 
+#if (BINARY_POPULATION == 1)
+   if (loadCheckpoint(fileName))
+   {
+      return;
+   }
+#endif
+
    if ((fp = fopen(fileName, "r")) == NULL)
    {
       sprintf(Log::messageBuf, "Cannot load population file %s", fileName);
@@ -507,6 +978,9 @@ void loadPopulation(char *fileName)
 // Save evolution population.
 void savePopulation(char *fileName)
 {
+#if (BINARY_POPULATION == 1)
+   saveCheckpoint(fileName);
+#else
    FILE *fp;
 
    if ((fp = fopen(fileName, "w")) == NULL)
@@ -521,6 +995,7 @@ void savePopulation(char *fileName)
       Genome::write(fp, Population[i]->genome);
    }
    fclose(fp);
+#endif
 }
 
 
@@ -556,6 +1031,9 @@ void terminate(int code)
          Population[i] = NULL;
       }
    }
+#if (FARM_EVALUATION == 1)
+   closeFarm();
+#endif
 
 #ifdef WIN32
 #if (CHECK_MEMORY == 1)
@@ -610,6 +1088,18 @@ void evolve()
    // Prune unfit members.
    prune();
 
+   // Record trajectory of fittest member.
+   if (TrajectoryFileName != NULL)
+   {
+      recordElite();
+   }
+
+   // Migrate genomes between islands.
+   if ((Island != -1) && (((CycleCount + 1) % MIGRATION_INTERVAL) == 0))
+   {
+      migrate();
+   }
+
    // Create new members by mutation.
    mutate();
 
@@ -621,80 +1111,361 @@ void evolve()
 // Evaluate member fitnesses.
 void evaluate()
 {
-   int    i, j;
+   int    i, j, job;
    Member *member;
-   long   seed;
 
    Log::logInformation("Evaluate:");
 
-   // Get random seed.
-   seed = Random::nextInt();
-   sprintf(Log::messageBuf, "  Random seed=%d", seed);
-   Log::logInformation();
+   // Get random seeds.
+   for (i = 0; i < EVALUATION_SEEDS; i++)
+   {
+      EvaluationSeeds[i] = EvolveRandom.nextInt();
+      sprintf(Log::messageBuf, "  Random seed=%ld", EvaluationSeeds[i]);
+      Log::logInformation();
+   }
+
+#if (EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+   // Find fitness of least fit elite member among evaluated members.
+   double fitnesses[POPULATION_SIZE], fitness;
+   int    k, n;
+   for (i = n = 0; i < POPULATION_SIZE; i++)
+   {
+      member = Population[i];
+      if (member->age == 0)
+      {
+         continue;
+      }
+      fitness = member->fitness;
+      for (k = n; (k > 0) && (fitnesses[k - 1] < fitness); k--)
+      {
+         fitnesses[k] = fitnesses[k - 1];
+      }
+      fitnesses[k] = fitness;
+      n++;
+   }
+   if (n >= FIT_POPULATION_SIZE)
+   {
+      EliteCutoff = fitnesses[FIT_POPULATION_SIZE - 1];
+   }
+   else
+   {
+      EliteCutoff = 0.0;
+   }
+#endif
 
+
+   // Hash member genomes.
    for (i = 0; i < POPULATION_SIZE; i++)
    {
-      Random::setRand(seed);
+      EvaluationHashes[i] = Population[i]->genome->hash();
+   }
 
-      // Install member genome.
+   // Find jobs to evaluate: those whose evaluation is neither cached
+   // nor that of an identical earlier member with the same seed.
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      i      = JOB_MEMBER(job);
       member = Population[i];
+      EvaluationSources[job] = job;
+      EvaluationPending[job] = true;
+#if (RACE_EVALUATION == 1)
+      EvaluationRaced[job] = false;
+#endif
+#if (FITNESS_CACHE == 1)
+      if (getCachedEvaluation(job))
+      {
+         sprintf(Log::messageBuf, "  Member=%d, Seed=%d, Cached", i, JOB_SEED(job));
+         Log::logInformation();
+         EvaluationSources[job] = -1;
+         EvaluationPending[job] = false;
+         continue;
+      }
+      for (j = job - i; j < job; j++)
+      {
+         if (((EvaluationSources[j] == j) ||
+              (EvaluationSources[j] == DEFERRED_EVALUATION)) &&
+             (EvaluationHashes[JOB_MEMBER(j)] == EvaluationHashes[i]) &&
+             Population[JOB_MEMBER(j)]->genome->equals(member->genome))
+         {
+            sprintf(Log::messageBuf, "  Member=%d, Seed=%d, Duplicate of member=%d",
+                    i, JOB_SEED(job), JOB_MEMBER(j));
+            Log::logInformation();
+            EvaluationSources[job] = j;
+            EvaluationPending[job] = false;
+            break;
+         }
+      }
+      if (j < job)
+      {
+         continue;
+      }
+#endif
 
-      // Create automaton containing morphogen.
-      delete automaton;
-      automaton = new Automaton();
-      assert(automaton != NULL);
-      morphogen = &automaton->morphogen;
+#if (NEUTRAL_VARIANTS == 1)
+      // Defer variant until its parents are evaluated.
+      if (member->parents[0] != -1)
+      {
+         EvaluationSources[job] = DEFERRED_EVALUATION;
+         EvaluationPending[job] = false;
+      }
+#endif
+   }
 
-      // Load member genome into morphogen.
-      morphogen->setGenome(member->genome->duplicate());
+   // Evaluate jobs.
+   evaluatePending();
+   applySources();
 
-      // Load test bodies into morphogen.
-      if (!morphogen->load(TestBodies, NumTestBodies))
+#if (NEUTRAL_VARIANTS == 1)
+   // Evaluate variants that are not neutral.
+   for (job = 0; job < EVALUATION_JOBS; job++)
+   {
+      if (EvaluationSources[job] != DEFERRED_EVALUATION)
       {
-         Log::logError("Cannot load morphogen");
-         exit(1);
+         continue;
       }
-
-#if (FORAGE_EVOLVE == 1 && FORAGING_MOVEMENT_SCREEN == 1)
-      if (morphogen->isMobile(21) ||
-          morphogen->isMobile(22) ||
-          morphogen->isMobile(23))
+      i      = JOB_MEMBER(job);
+      member = Population[i];
+      EvaluationSources[job] = job;
+      EvaluationPending[job] = true;
+      for (j = 0; j < 2; j++)
       {
-         MobileFound       = true;
-         Log::LOGGING_FLAG = EVOLVE_LOGGING;
+         if ((member->parents[j] != -1) &&
+             isNeutralVariant(job, member->parents[j]))
+         {
+            sprintf(Log::messageBuf, "  Member=%d, Seed=%d, Neutral variant of member=%d",
+                    i, JOB_SEED(job), member->parents[j]);
+            Log::logInformation();
+            EvaluationSources[job] = job - i + member->parents[j];
+            EvaluationPending[job] = false;
+            break;
+         }
+      }
+   }
+   evaluatePending();
+   applySources();
 #endif
 
-      // Morph.
-      for (j = 0; j < MORPH_CYCLES; j++)
+   // Accumulate fitnesses in member order.
+   for (i = 0; i < POPULATION_SIZE; i++)
+   {
+      for (job = i; job < EVALUATION_JOBS; job += POPULATION_SIZE)
       {
-         automaton->morph();
+#if (RACE_EVALUATION == 1)
+         if (EvaluationRaced[job])
+         {
+            sprintf(Log::messageBuf, "  Member=%d, Seed=%d, Raced out at cycle=%d",
+                    i, JOB_SEED(job), EvaluationCycles[job]);
+            Log::logInformation();
+         }
+         else
+#endif
+         if (EvaluationCycles[job] < MORPH_CYCLES)
+         {
+            sprintf(Log::messageBuf, "  Member=%d, Seed=%d, Terminated at cycle=%d",
+                    i, JOB_SEED(job), EvaluationCycles[job]);
+            Log::logInformation();
+         }
 
-         // Display?
-         if (Display)
+#if (FITNESS_CACHE == 1)
+         // Cache evaluation: a raced out evaluation is incomplete.
+         if (EvaluationSources[job] == job)
          {
-            display();
+#if (RACE_EVALUATION == 1)
+            if (!EvaluationRaced[job])
+#endif
+            cacheEvaluation(job);
          }
+#endif
       }
+      accumulateFitness(i);
+      Population[i]->parents[0] = Population[i]->parents[1] = -1;
+   }
 
-#if (FORAGE_EVOLVE == 1 && FORAGING_MOVEMENT_SCREEN == 1)
+#if (RACE_EVALUATION == 1)
+   // Log morph cycles run and those saved, at most, by racing.
+   int cycles, saved;
+   for (job = cycles = saved = 0; job < EVALUATION_JOBS; job++)
+   {
+      if (EvaluationSources[job] == job)
+      {
+         cycles += EvaluationCycles[job];
+         if (EvaluationRaced[job])
+         {
+            saved += MORPH_CYCLES - EvaluationCycles[job];
+         }
+      }
    }
-   else
+   sprintf(Log::messageBuf, "  Morph cycles=%d, Saved by racing=%d", cycles, saved);
+   Log::logInformation();
+#endif
+}
+
+
+// Apply evaluations of source jobs.
+// A source job precedes the jobs it applies to.
+void applySources()
+{
+   int i, j;
+
+   for (i = 0; i < EVALUATION_JOBS; i++)
    {
-      if (Display)
+      j = EvaluationSources[i];
+      if ((j < 0) || (j == i))
+      {
+         continue;
+      }
+      EvaluationFitnesses[i] = EvaluationFitnesses[j];
+      EvaluationCycles[i]    = EvaluationCycles[j];
+#if (RACE_EVALUATION == 1)
+      EvaluationRaced[i] = EvaluationRaced[j];
+#endif
+#if (TRACE_GENES == 1)
+      for (j = 0; j < NUM_GENES; j++)
       {
-         display();
+         EvaluationFired[i][j] = EvaluationFired[EvaluationSources[i]][j];
       }
+#endif
+   }
+}
+
+
+#if (FITNESS_CACHE == 1)
+// Get cache entry for genome hash and seed.
+// The entry may hold the evaluation of another genome and seed.
+FitnessMemo *getFitnessMemo(GENOME_HASH hash, long seed)
+{
+   GENOME_HASH key;
+
+   key = hash ^ ((GENOME_HASH)seed * 0x9E3779B97F4A7C15ULL);
+   return(&FitnessCache[(int)((key >> 32) & (FITNESS_CACHE_SIZE - 1))]);
+}
+
+
+// Get cached evaluation of job.
+bool getCachedEvaluation(int job)
+{
+   GENOME_HASH hash  = EvaluationHashes[JOB_MEMBER(job)];
+   long        seed  = EvaluationSeeds[JOB_SEED(job)];
+   FitnessMemo *memo = getFitnessMemo(hash, seed);
+
+   if (!memo->valid || (memo->hash != hash) || (memo->seed != seed) ||
+       !memo->genome->equals(Population[JOB_MEMBER(job)]->genome))
+   {
+      return(false);
+   }
+   EvaluationFitnesses[job] = memo->fitness;
+   EvaluationCycles[job]    = memo->cycles;
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      EvaluationFired[job][i] = memo->fired[i];
    }
 #endif
+   return(true);
+}
 
-      // Accumulate fitness.
-      member->fitness = (member->fitness * member->age) + morphogen->getFitness();
-      member->age++;
-      member->fitness /= member->age;
-      sprintf(Log::messageBuf, "  Member=%d, Fitness=%f, Age=%d",
-              i, member->fitness, member->age);
-      Log::logInformation();
+
+// Cache evaluation of job.
+void cacheEvaluation(int job)
+{
+   GENOME_HASH hash  = EvaluationHashes[JOB_MEMBER(job)];
+   long        seed  = EvaluationSeeds[JOB_SEED(job)];
+   FitnessMemo *memo = getFitnessMemo(hash, seed);
+
+   if (memo->valid)
+   {
+      delete memo->genome;
+   }
+   memo->valid   = true;
+   memo->hash    = hash;
+   memo->genome  = Population[JOB_MEMBER(job)]->genome->duplicate();
+   memo->seed    = seed;
+   memo->fitness = EvaluationFitnesses[job];
+   memo->cycles  = EvaluationCycles[job];
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      memo->fired[i] = EvaluationFired[job][i];
    }
+#endif
+}
+
+
+#endif
+
+#if (NEUTRAL_VARIANTS == 1)
+// Is member of job a neutral variant of parent for the job's seed?
+// It is if its genes differ only in genes that never fired in the
+// parent's evaluation and that match the same neighborhoods, so that
+// they cannot fire for it either: it then morphs exactly as the parent
+// did.
+bool isNeutralVariant(int job, int parentIndex)
+{
+   int  parentJob;
+   Gene *gene, *parentGene;
+
+   parentJob = job - JOB_MEMBER(job) + parentIndex;
+   if (EvaluationSources[parentJob] == DEFERRED_EVALUATION)
+   {
+      return(false);
+   }
+#if (RACE_EVALUATION == 1)
+   if (EvaluationRaced[parentJob])
+   {
+      return(false);
+   }
+#endif
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      gene       = Population[JOB_MEMBER(job)]->genome->genes[i];
+      parentGene = Population[parentIndex]->genome->genes[i];
+      if (gene->equals(parentGene))
+      {
+         continue;
+      }
+      if (EvaluationFired[parentJob][i] || !gene->matchesSame(parentGene))
+      {
+         return(false);
+      }
+   }
+   return(true);
+}
+
+
+#endif
+
+// Accumulate member evaluation fitness: the member's fitness is the
+// mean over generations of the mean of its seed evaluations.
+void accumulateFitness(int memberIndex)
+{
+   Member *member = Population[memberIndex];
+   double mean, variance, fitness;
+   int    job;
+
+   mean = variance = 0.0;
+   for (job = memberIndex; job < EVALUATION_JOBS; job += POPULATION_SIZE)
+   {
+      mean += EvaluationFitnesses[job];
+   }
+   mean /= EVALUATION_SEEDS;
+   for (job = memberIndex; job < EVALUATION_JOBS; job += POPULATION_SIZE)
+   {
+      fitness   = EvaluationFitnesses[job] - mean;
+      variance += fitness * fitness;
+   }
+   variance /= EVALUATION_SEEDS;
+#if (EVALUATION_SEEDS > 1)
+   sprintf(Log::messageBuf, "  Member=%d, Seed mean=%f, Seed variance=%f",
+           memberIndex, mean, variance);
+   Log::logInformation();
+#endif
+
+   member->fitness = (member->fitness * member->age) + mean;
+   member->age++;
+   member->fitness /= member->age;
+   sprintf(Log::messageBuf, "  Member=%d, Fitness=%f, Age=%d",
+           memberIndex, member->fitness, member->age);
+   Log::logInformation();
 }
 
 
@@ -746,6 +1517,170 @@ void prune()
 }
 
 
+// Record trajectory of fittest member: its evaluation with the first
+// generation seed is repeated in an automaton recording its trajectory.
+// Called when only the fit members, in fitness order, remain.
+void recordElite()
+{
+   int         j;
+   long        position;
+   FILE        *fp;
+   Member      *member;
+   Automaton   *recorder;
+   Trajectory  *trajectory;
+   Random      streams;
+   GENOME_HASH hash;
+
+   member = Population[0];
+   hash   = member->genome->hash();
+   if (TrajectoryRecorded && (hash == TrajectoryHash))
+   {
+      return;
+   }
+   if ((fp = fopen(TrajectoryFileName, "ab")) == NULL)
+   {
+      sprintf(Log::messageBuf, "Cannot open trajectory file %s", TrajectoryFileName);
+      Log::logError();
+      exit(1);
+   }
+   fseek(fp, 0, SEEK_END);
+   position = ftell(fp);
+
+   // Load world for first seed.
+   streams.setRand(EvaluationSeeds[0]);
+   recorder = new Automaton();
+   assert(recorder != NULL);
+   recorder->morphogen.setGenome(member->genome->duplicate());
+   recorder->mechanics.random = streams.split(LOAD_STREAM);
+   if (!recorder->morphogen.load(TestBodies, NumTestBodies))
+   {
+      Log::logError("Cannot load morphogen");
+      exit(1);
+   }
+   recorder->mechanics.random = streams.split(MEMBER_STREAM);
+
+   // Morph, recording trajectory.
+   trajectory = new Trajectory(fp, true, TRAJECTORY_KEY_INTERVAL);
+   assert(trajectory != NULL);
+   recorder->trajectory = trajectory;
+   for (j = 0; j < MORPH_CYCLES; j++)
+   {
+      recorder->morph();
+
+#if (EARLY_TERMINATION == 1)
+      if ((((j + 1) % TERMINATION_CHECK_CYCLES) == 0) &&
+          terminateEvaluation(recorder, member))
+      {
+         j++;
+         break;
+      }
+#endif
+   }
+   sprintf(Log::messageBuf, "Trajectory: position=%ld, cycles=%d, fitness=%f",
+           position, j, recorder->morphogen.getFitness());
+   Log::logInformation();
+   delete trajectory;
+   delete recorder;
+   fclose(fp);
+   TrajectoryRecorded = true;
+   TrajectoryHash     = hash;
+}
+
+
+// Migrate genomes between islands: take in the latest genomes
+// published by the preceding island, unless already taken, in place of
+// the least fit members, and publish the fittest genomes.
+// An island's migration file holds its emigration stamp and the stamp of
+// the immigration it last took, then its emigrants, so that a resumed
+// island continues both stamps and does not take the same immigrants
+// again. Called when only the fit members, in fitness order, remain.
+void migrate()
+{
+   int    i, stamp, stamp2;
+   FILE   *fp;
+   char   fileName[BUFSIZ], tempFileName[BUFSIZ];
+   Genome *genomes[NUM_MIGRANTS];
+
+   Log::logInformation("Migrate:");
+
+   // Continue stamps of a resumed run.
+   getMigrationFileName(Island, "txt", fileName);
+   if ((EmigrationStamp == 0) && ((fp = fopen(fileName, "r")) != NULL))
+   {
+      if (fscanf(fp, "%d %d", &stamp, &stamp2) == 2)
+      {
+         EmigrationStamp  = stamp;
+         ImmigrationStamp = stamp2;
+      }
+      fclose(fp);
+   }
+
+   // Take in genomes of preceding island.
+   getMigrationFileName((Island + NumIslands - 1) % NumIslands,
+                        "txt", fileName);
+   if ((fp = fopen(fileName, "r")) != NULL)
+   {
+      if ((fscanf(fp, "%d %d", &stamp, &stamp2) == 2) &&
+          (stamp != ImmigrationStamp))
+      {
+         for (i = 0; i < NUM_MIGRANTS; i++)
+         {
+            genomes[i] = Genome::read(fp);
+         }
+         ImmigrationStamp = stamp;
+         for (i = 0; i < NUM_MIGRANTS; i++)
+         {
+            delete Population[FIT_POPULATION_SIZE - 1 - i];
+            Population[FIT_POPULATION_SIZE - 1 - i] = new Member(genomes[i]);
+            assert(Population[FIT_POPULATION_SIZE - 1 - i] != NULL);
+         }
+         sprintf(Log::messageBuf, "  Immigrants=%d, Stamp=%d", NUM_MIGRANTS, stamp);
+         Log::logInformation();
+      }
+      fclose(fp);
+   }
+
+   // Publish fittest genomes and the stamps: write and rename the
+   // migration file, so that it is never read partially written.
+   EmigrationStamp++;
+   getMigrationFileName(Island, "txt", fileName);
+   getMigrationFileName(Island, "tmp", tempFileName);
+   if ((fp = fopen(tempFileName, "w")) == NULL)
+   {
+      snprintf(Log::messageBuf, sizeof(Log::messageBuf),
+               "Cannot save to migration file %.256s", tempFileName);
+      Log::logError();
+      exit(1);
+   }
+   fprintf(fp, "%d %d\n", EmigrationStamp, ImmigrationStamp);
+   for (i = 0; i < NUM_MIGRANTS; i++)
+   {
+      Genome::write(fp, Population[i]->genome);
+   }
+   fclose(fp);
+#ifdef WIN32
+   remove(fileName);
+#endif
+   if (rename(tempFileName, fileName) != 0)
+   {
+      snprintf(Log::messageBuf, sizeof(Log::messageBuf),
+               "Cannot save to migration file %.256s", fileName);
+      Log::logError();
+      exit(1);
+   }
+   sprintf(Log::messageBuf, "  Emigrants=%d, Stamp=%d", NUM_MIGRANTS, EmigrationStamp);
+   Log::logInformation();
+}
+
+
+// Get name of island migration file (fileName holds BUFSIZ characters).
+void getMigrationFileName(int island, char *suffix, char *fileName)
+{
+   snprintf(fileName, BUFSIZ, "%s/island%d.%s",
+            MigrationDirectory, island, suffix);
+}
+
+
 // Mutate members.
 void mutate()
 {
@@ -758,7 +1693,7 @@ void mutate()
    for (i = 0; i < NUM_MUTANTS; i++)
    {
       // Select a fit member to mutate.
-      j      = Random::nextInt(FIT_POPULATION_SIZE);
+      j      = EvolveRandom.nextInt(FIT_POPULATION_SIZE);
       member = Population[j];
       sprintf(Log::messageBuf, "  Member=%d", j);
       Log::logInformation();
@@ -767,6 +1702,7 @@ void mutate()
       genome = member->genome->duplicate();
       mutant = new Member(genome);
       assert(mutant != NULL);
+      mutant->parents[0] = j;
       Population[FIT_POPULATION_SIZE + i] = mutant;
 
       // Mutate.
@@ -784,11 +1720,11 @@ void mutate()
 
 #if (FORAGE_EVOLVE == 1 && FORAGING_HILL_CLIMB == 1)
          // Random hill-climb of selected values.
-         switch (Random::nextInt(4))
+         switch (EvolveRandom.nextInt(4))
          {
          case 0:
 #if (FORAGING_GENES_INITIALIZATION != EFFECTIVE_FORAGING_VALUES)
-            if (Random::nextBoolean())
+            if (EvolveRandom.nextBoolean())
             {
                gene->orientation.direction++;
                gene->orientation.direction %= 8;
@@ -805,7 +1741,7 @@ void mutate()
             break;
 
          case 1:
-            if (Random::nextBoolean())
+            if (EvolveRandom.nextBoolean())
             {
                gene->strength += Gene::STRENGTH_QUANTUM;
             }
@@ -824,7 +1760,7 @@ void mutate()
             break;
 
          case 2:
-            if (Random::nextBoolean())
+            if (EvolveRandom.nextBoolean())
             {
                gene->delay++;
             }
@@ -843,7 +1779,7 @@ void mutate()
             break;
 
          case 3:
-            if (Random::nextBoolean())
+            if (EvolveRandom.nextBoolean())
             {
                gene->duration++;
             }
@@ -864,10 +1800,11 @@ void mutate()
 
 #else
          // Mutate action index?
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
             // Create a viable gene for chosen action.
-            morphogen->createViableGene(gene, Random::nextInt(NUM_ACTIONS));
+            morphogen->createViableGene(gene, EvolveRandom.nextInt(NUM_ACTIONS),
+                                        &EvolveRandom);
             continue;
          }
 
@@ -876,11 +1813,11 @@ void mutate()
          {
             for (y = 0; y < 3; y++)
             {
-               if (Random::nextDouble() < MUTATION_RATE)
+               if (EvolveRandom.nextDouble() < MUTATION_RATE)
                {
-                  if (Random::nextBoolean())
+                  if (EvolveRandom.nextBoolean())
                   {
-                     switch (Random::nextInt(3))
+                     switch (EvolveRandom.nextInt(3))
                      {
                      case 0:
                         gene->types[x][y] = Gene::IGNORE_CELL;
@@ -897,23 +1834,23 @@ void mutate()
                   }
                   else
                   {
-                     gene->types[x][y] = Random::nextInt(NUM_PARTICLE_TYPES);
+                     gene->types[x][y] = EvolveRandom.nextInt(NUM_PARTICLE_TYPES);
                   }
                }
             }
          }
 
          // Mutate target location.
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
-            k = Random::nextInt(Gene::MAX_TARGET_DISTANCE + 1);
-            if (Random::nextBoolean())
+            k = EvolveRandom.nextInt(Gene::MAX_TARGET_DISTANCE + 1);
+            if (EvolveRandom.nextBoolean())
             {
                k = -k;
             }
             gene->dx = k;
-            k        = Random::nextInt(Gene::MAX_TARGET_DISTANCE + 1);
-            if (Random::nextBoolean())
+            k        = EvolveRandom.nextInt(Gene::MAX_TARGET_DISTANCE + 1);
+            if (EvolveRandom.nextBoolean())
             {
                k = -k;
             }
@@ -921,41 +1858,44 @@ void mutate()
          }
 
          // Mutate parameters.
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
-            gene->type = Random::nextInt(NUM_PARTICLE_TYPES);
+            gene->type = EvolveRandom.nextInt(NUM_PARTICLE_TYPES);
          }
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
-            gene->orientation.direction = Random::nextInt(8);
-            gene->orientation.mirrored  = Random::nextBoolean();
+            gene->orientation.direction = EvolveRandom.nextInt(8);
+            gene->orientation.mirrored  = EvolveRandom.nextBoolean();
          }
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
             k = (int)(Gene::MAX_STRENGTH / Gene::STRENGTH_QUANTUM);
             gene->strength =
-               (double)(Random::nextInt(k + 1)) * Gene::STRENGTH_QUANTUM;
+               (double)(EvolveRandom.nextInt(k + 1)) * Gene::STRENGTH_QUANTUM;
          }
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
             k = (int)(Gene::MAX_TENDENCY_MAGNITUDE / Gene::TENDENCY_QUANTUM);
             gene->tendency =
-               (double)(Random::nextInt(k + 1)) * Gene::TENDENCY_QUANTUM;
-            if (Random::nextBoolean())
+               (double)(EvolveRandom.nextInt(k + 1)) * Gene::TENDENCY_QUANTUM;
+            if (EvolveRandom.nextBoolean())
             {
                gene->tendency = -gene->tendency;
             }
          }
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
-            gene->delay = Random::nextInt(Gene::MAX_DELAY + 1);
+            gene->delay = EvolveRandom.nextInt(Gene::MAX_DELAY + 1);
          }
-         if (Random::nextDouble() < MUTATION_RATE)
+         if (EvolveRandom.nextDouble() < MUTATION_RATE)
          {
-            gene->duration = Random::nextInt(Gene::MAX_DURATION) + 1;
+            gene->duration = EvolveRandom.nextInt(Gene::MAX_DURATION) + 1;
          }
 #endif
       }
+
+      // Index mutated genes.
+      genome->compile();
    }
 }
 
@@ -963,7 +1903,7 @@ void mutate()
 // Produce offspring though matings.
 void mate()
 {
-   int i, j, k;
+   int i, j, k, parent1, parent2;
    Member *member1, *member2, *offspring;
    Genome *offspringGenome;
 
@@ -971,21 +1911,23 @@ void mate()
    for (i = 0; i < NUM_OFFSPRING; i++)
    {
       // Select a pair of fit members to mate.
-      j       = Random::nextInt(FIT_POPULATION_SIZE);
+      j       = EvolveRandom.nextInt(FIT_POPULATION_SIZE);
       member1 = Population[j];
-      while ((k = Random::nextInt(FIT_POPULATION_SIZE)) == j)
+      while ((k = EvolveRandom.nextInt(FIT_POPULATION_SIZE)) == j)
       {
       }
       member2 = Population[k];
       sprintf(Log::messageBuf, "  Members=%d,%d", j, k);
       Log::logInformation();
+      parent1 = j;
+      parent2 = k;
 
       // Create offspring.
       offspringGenome = morphogen->createGenome();
       offspringGenome->clear();
       for (j = 0; j < NUM_GENES; j++)
       {
-         if (Random::nextBoolean())
+         if (EvolveRandom.nextBoolean())
          {
             offspringGenome->genes[j] =
                member1->genome->genes[j]->duplicate();
@@ -996,8 +1938,11 @@ void mate()
                member2->genome->genes[j]->duplicate();
          }
       }
+      offspringGenome->compile();
       offspring = new Member(offspringGenome);
       assert(offspring != NULL);
+      offspring->parents[0] = parent1;
+      offspring->parents[1] = parent2;
       Population[FIT_POPULATION_SIZE + NUM_MUTANTS + i] = offspring;
    }
 }
@@ -0,0 +1,277 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Evolve program definitions shared by evolution and evaluation:
+ * evolution parameters and options, population members and the
+ * evolution state that members are evaluated with.
+ */
+
+#ifndef __EVOLVE__
+#define __EVOLVE__
+
+#include "../base/Parameters.h"
+#include "../base/Automaton.hpp"
+#include "../util/Log.hpp"
+
+// Evolution parameters.
+#define FIT_POPULATION_SIZE    10
+#define NUM_MUTANTS            8
+#define NUM_OFFSPRING          2
+#define POPULATION_SIZE        (FIT_POPULATION_SIZE + NUM_MUTANTS + NUM_OFFSPRING)
+#define MUTATION_RATE          0.1
+#define MORPH_CYCLES           1000
+#define EVOLVE_LOGGING         LOG_TO_BOTH
+
+// Evaluation seeds: each generation every member is evaluated with
+// this many seeds (worlds and random numbers), and its generation
+// fitness is the mean of its evaluations.
+#define EVALUATION_SEEDS       4
+
+// Evolve food foraging.
+#define FORAGE_EVOLVE          1
+
+// Foraging hill-climbing optimization of selected values.
+#define FORAGING_HILL_CLIMB    0
+
+// Clone world: the world loaded for the first member of a generation is
+// snapshot and restored for the others instead of being reloaded.
+// (Loading depends only on the random seed, not on the genome.)
+#define CLONE_WORLD    1
+
+// Threaded evaluation: the world is loaded once per generation and
+// members are evaluated concurrently by a pool of threads, each member
+// in its own automaton restored from the world snapshot. Random numbers
+// are per-world and scopes and log messages per-thread, so results are
+// those of an in-order evaluation. Racing evaluation runs its stages in
+// the same pool. (Not used in display mode.)
+#ifdef UNIX
+#define THREAD_EVALUATION       1
+#else
+#define THREAD_EVALUATION       0
+#endif
+#if (THREAD_EVALUATION == 1)
+#define EVALUATION_THREADS      0 // 0 = one per online processor
+#endif
+#if (THREAD_EVALUATION == 1 && !defined(UNIX))
+#error "THREAD_EVALUATION requires UNIX"
+#endif
+
+// Forked evaluation: the world is loaded once per generation and each
+// member is evaluated in a forked process that inherits it copy-on-write
+// and returns its fitness over a pipe. (Not used in display mode;
+// UNIX only, and exclusive of threaded and racing evaluation.)
+#define FORK_EVALUATION         0
+#if (FORK_EVALUATION == 1)
+#define EVALUATION_PROCESSES    0 // 0 = one per online processor
+#endif
+#if (FORK_EVALUATION == 1 && !defined(UNIX))
+#error "FORK_EVALUATION requires UNIX"
+#endif
+
+// Early termination of member evaluation: every TERMINATION_CHECK_CYCLES
+// morph cycles the termination tests are applied, and the member's
+// evaluation ends as soon as one of them succeeds.
+#define EARLY_TERMINATION           1
+#if (EARLY_TERMINATION == 1)
+#define TERMINATION_CHECK_CYCLES    50
+#define TERMINATE_BELOW_ELITE       0
+#endif
+
+// The elite test bounds a single evaluation against the generation
+// fitness, which is a mean over seeds only when there are several.
+#if (EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1 && EVALUATION_SEEDS != 1)
+#error "TERMINATE_BELOW_ELITE requires EVALUATION_SEEDS = 1"
+#endif
+
+// Fitness cache: a member's evaluation depends only on its genome and
+// the generation seed, so fitnesses are cached by genome hash and seed,
+// and identical genomes within a generation are evaluated once. Genomes
+// with equal hashes are compared gene by gene before reuse.
+// (Not with evaluation terminated by elite fitness, which depends on
+// the member's history.)
+#define FITNESS_CACHE         1
+#if (FITNESS_CACHE == 1)
+#define FITNESS_CACHE_SIZE    1024 // power of 2
+#endif
+#if (FITNESS_CACHE == 1 && EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+#error "FITNESS_CACHE cannot be used with TERMINATE_BELOW_ELITE"
+#endif
+
+// Neutral variants: a variant whose genes differ from a parent's only
+// in genes that never matched in the parent's evaluation, and that
+// match the same neighborhoods, morphs exactly as the parent did and
+// takes the parent's fitness without evaluation. (Not with evaluation
+// terminated by elite fitness.)
+#define NEUTRAL_VARIANTS    1
+#if (NEUTRAL_VARIANTS == 1 && TRACE_GENES == 0)
+#error "NEUTRAL_VARIANTS requires TRACE_GENES"
+#endif
+#if (NEUTRAL_VARIANTS == 1 && EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+#error "NEUTRAL_VARIANTS cannot be used with TERMINATE_BELOW_ELITE"
+#endif
+
+// Racing evaluation: members are morphed in stages to successively
+// doubled horizons, and after each stage an evaluation is raced out
+// (ended) if the fitness bound of each member it applies to is below
+// the fitness FIT_POPULATION_SIZE other members are sure to reach.
+// The bound is the energy a body could reach by digesting all remaining
+// food (see boundFitness()); a genome that can make food is unbounded
+// and never raced out. Raced out members cannot survive pruning, and
+// the others are evaluated fully, so selection is unchanged. (Not used
+// in display mode.)
+#define RACE_EVALUATION    1
+#if (RACE_EVALUATION == 1)
+#define RACE_HORIZON       125 // first stage horizon
+#endif
+#if (FORK_EVALUATION == 1 && (THREAD_EVALUATION == 1 || RACE_EVALUATION == 1))
+#error "FORK_EVALUATION cannot be used with THREAD_EVALUATION or RACE_EVALUATION"
+#endif
+
+// Island migration: a run given an island is one of a ring of islands
+// evolved by separate processes. Every MIGRATION_INTERVAL generations
+// each island publishes its NUM_MIGRANTS fittest genomes to the shared
+// migration directory and takes in the latest genomes published by the
+// preceding island in place of its least fit members.
+#define MIGRATION_INTERVAL    10
+#define NUM_MIGRANTS          2
+
+// Farm evaluation: a run given a farm socket is the coordinator of a
+// farm of worker runs on the local host that connect to the socket.
+// The coordinator sends each worker the test bodies once, then gives
+// it an evaluation job (seed and packed member genome) whenever it is
+// idle, so that faster workers take more jobs. A job outstanding for
+// FARM_TIMEOUT seconds is given again to an idle worker, as is the job
+// of a worker that disconnects, and the first result returned is kept.
+// Workers evaluate jobs as an in-order evaluation does, from genomes
+// only, so not with evaluation terminated by elite fitness. (Not used
+// in display mode; farm evaluation takes precedence over the others.)
+#ifdef UNIX
+#define FARM_EVALUATION     1
+#else
+#define FARM_EVALUATION     0
+#endif
+#if (FARM_EVALUATION == 1)
+#define MAX_FARM_WORKERS    64
+#define FARM_TIMEOUT        10 // seconds
+#endif
+#if (FARM_EVALUATION == 1 && !defined(UNIX))
+#error "FARM_EVALUATION requires UNIX"
+#endif
+#if (FARM_EVALUATION == 1 && EARLY_TERMINATION == 1 && TERMINATE_BELOW_ELITE == 1)
+#error "FARM_EVALUATION cannot be used with TERMINATE_BELOW_ELITE"
+#endif
+
+// Foraging movement screening (see Maxwell.hpp) evaluates members
+// in order.
+#if (FORAGING_MOVEMENT_SCREEN == 1 && (THREAD_EVALUATION == 1 || FORK_EVALUATION == 1 || RACE_EVALUATION == 1 || FARM_EVALUATION == 1))
+#error "FORAGING_MOVEMENT_SCREEN requires in-order evaluation"
+#endif
+
+// Binary population: the population is saved as a checkpoint of
+// fixed-size member records (fitness, age and packed genes) following
+// a versioned header with a checksum of the records. It is written to
+// a temporary file renamed to the population file, so that it is never
+// found partly written, and is memory-mapped to load. (Text population
+// files can still be loaded.)
+#define BINARY_POPULATION     1
+#if (BINARY_POPULATION == 1)
+#define POPULATION_MAGIC      "MAXPOP"
+#define POPULATION_VERSION    1
+#endif
+
+// Elite trajectories: a run given a trajectory file appends to it,
+// after each generation's pruning, the trajectory of its fittest member
+// evaluated again with the generation's first seed, unless that member
+// has the genome last recorded. The trajectory has a keyframe every
+// TRAJECTORY_KEY_INTERVAL morphs (see Trajectory.hpp).
+#define TRAJECTORY_KEY_INTERVAL    100
+
+// Random number streams split from a generation seed: the world is
+// loaded from one stream and every member morphs with the member
+// stream, so that members are compared on common random numbers.
+#define LOAD_STREAM      0
+#define MEMBER_STREAM    1
+
+// Population member.
+class Member
+{
+public:
+
+   Genome *genome;
+   double fitness;
+   int    age;
+
+   // Indices of parents in the generation that produced the
+   // member (-1 if none).
+   int parents[2];
+
+   // Constructors.
+   Member(Genome *genome)
+   {
+      this->genome = genome;
+      fitness      = 0.0;
+      age          = 0;
+      parents[0]   = parents[1] = -1;
+   }
+
+
+   Member(Genome *genome, double fitness, int age)
+   {
+      this->genome  = genome;
+      this->fitness = fitness;
+      this->age     = age;
+      parents[0]    = parents[1] = -1;
+   }
+
+
+   // Destructor.
+   ~Member()
+   {
+      delete genome;
+   }
+};
+
+
+// Automaton.
+extern Automaton *automaton;
+
+// Morphogen.
+extern MORPHOGEN *morphogen;
+
+// Test bodies.
+extern Body **TestBodies;
+extern int  NumTestBodies;
+
+// Population.
+extern Member *Population[POPULATION_SIZE];
+
+// Display mode?
+extern bool Display;
+
+#if (FORAGING_MOVEMENT_SCREEN == 1)
+extern bool MobileFound;
+#endif
+
+// Read test bodies.
+void readBodies(FILE *fp);
+
+// Terminate.
+void terminate(int);
+
+// Display.
+void display();
+#endif
@@ -151,6 +151,7 @@ Signal *BondMorph::createBondSignal(Particle *particle, int targetType)
    parameters[1] = (void *)targetType;
    Signal *signal = new Signal(BOND->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(2, 1);
    return(signal);
 }
 
@@ -165,5 +166,6 @@ Signal *BondMorph::createUnbondSignal(Particle *particle, int targetType)
    parameters[1] = (void *)targetType;
    Signal *signal = new Signal(UNBOND->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(2, 1);
    return(signal);
 }
@@ -194,6 +194,7 @@ Signal *CreateMorph::createCreateSignal(Particle *particle,
    parameters[3] = (void *)type;
    Signal *signal = new Signal(CREATE->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(4, 1);
    return(signal);
 }
 
@@ -207,5 +208,6 @@ Signal *CreateMorph::createDestroySignal(int targetType)
    parameters[0] = (void *)targetType;
    Signal *signal = new Signal(DESTROY->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(1, 0);
    return(signal);
 }
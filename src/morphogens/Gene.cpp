@@ -76,11 +76,13 @@ void Gene::clear()
    tendency = 0.0;
    delay    = 0;
    duration = 1;
+
+   compile();
 }
 
 
 // Randomize gene.
-void Gene::randomize()
+void Gene::randomize(Random *random)
 {
    int x, y, i;
 
@@ -89,7 +91,7 @@ void Gene::randomize()
    {
       for (y = 0; y < 3; y++)
       {
-         types[x][y] = Random::nextInt(NUM_PARTICLE_TYPES + 3);
+         types[x][y] = random->nextInt(NUM_PARTICLE_TYPES + 3);
          switch (types[x][y])
          {
          case NUM_PARTICLE_TYPES:
@@ -108,101 +110,115 @@ void Gene::randomize()
    }
 
    // Randomize action index.
-   action = Random::nextInt(NUM_ACTIONS);
+   action = random->nextInt(NUM_ACTIONS);
 
    // Randomize target location.
-   i = Random::nextInt(MAX_TARGET_DISTANCE + 1);
-   if (Random::nextBoolean())
+   i = random->nextInt(MAX_TARGET_DISTANCE + 1);
+   if (random->nextBoolean())
    {
       i = -i;
    }
    dx = i;
-   i  = Random::nextInt(MAX_TARGET_DISTANCE + 1);
-   if (Random::nextBoolean())
+   i  = random->nextInt(MAX_TARGET_DISTANCE + 1);
+   if (random->nextBoolean())
    {
       i = -i;
    }
    dy = i;
 
    // Randomize parameters.
-   type = Random::nextInt(NUM_PARTICLE_TYPES);
-   orientation.direction = Random::nextInt(8);
-   orientation.mirrored  = Random::nextBoolean();
+   type = random->nextInt(NUM_PARTICLE_TYPES);
+   orientation.direction = random->nextInt(8);
+   orientation.mirrored  = random->nextBoolean();
    i        = (int)(MAX_STRENGTH / STRENGTH_QUANTUM);
-   strength = (double)(Random::nextInt(i + 1)) * STRENGTH_QUANTUM;
+   strength = (double)(random->nextInt(i + 1)) * STRENGTH_QUANTUM;
    i        = (int)(MAX_TENDENCY_MAGNITUDE / TENDENCY_QUANTUM);
    tendency =
-      (double)(Random::nextInt(i + 1)) * TENDENCY_QUANTUM;
-   if (Random::nextBoolean())
+      (double)(random->nextInt(i + 1)) * TENDENCY_QUANTUM;
+   if (random->nextBoolean())
    {
       tendency = -tendency;
    }
-   delay    = Random::nextInt(MAX_DELAY + 1);
-   duration = Random::nextInt(MAX_DURATION + 1);
+   delay    = random->nextInt(MAX_DELAY + 1);
+   duration = random->nextInt(MAX_DURATION + 1);
+
+   compile();
 }
 
 
-// Determine cell neighborhood match.
-bool Gene::matchNeighborhood(Neighborhood *neighbors)
+// Compile matching types into per-orientation cell mask tests.
+void Gene::compile()
 {
-   int      x, y, x2, y2;
-   Cell     *cell;
-   Particle *particle;
-   bool     match;
-
-   std::list<Particle *>::const_iterator listItr;
+   int          i, x, y, x2, y2;
+   unsigned int mask;
+   Neighborhood neighbors;
+   Orientation  orientation;
 
-   for (x = 0; x < 3; x++)
+   for (i = 0; i < NUM_ORIENTATIONS; i++)
    {
-      for (y = 0; y < 3; y++)
+      orientation.direction = i % 8;
+      orientation.mirrored  = (i >= 8);
+      neighbors.transform(orientation);
+      numMatchTests = 0;
+      for (x = 0; x < 3; x++)
       {
-         if (types[x][y] == IGNORE_CELL)
-         {
-            continue;
-         }
-         x2 = x - 1;
-         y2 = y - 1;
-         neighbors->getCellLocation(x2, y2);
-         x2++;
-         y2++;
-         cell = neighbors->cells[x2][y2];
-         if (cell == NULL)
-         {
-            return(false);
-         }
-         if (types[x][y] == EMPTY_CELL)
+         for (y = 0; y < 3; y++)
          {
-            if (cell->particles.size() != 0)
+            if (types[x][y] == IGNORE_CELL)
             {
-               return(false);
+               continue;
             }
-         }
-         else if (types[x][y] == OCCUPIED_CELL)
-         {
-            if (cell->particles.size() == 0)
+            if (types[x][y] == EMPTY_CELL)
             {
-               return(false);
+               mask = 0;
             }
-         }
-         else
-         {
-            match = false;
-            for (listItr = cell->particles.begin();
-                 listItr != cell->particles.end(); listItr++)
+            else if (types[x][y] == OCCUPIED_CELL)
             {
-               particle = *listItr;
-               if (particle->type == types[x][y])
-               {
-                  match = true;
-                  break;
-               }
+               mask = OCCUPIED_MASK;
             }
-            if (!match)
+            else
             {
-               return(false);
+               mask = TYPE_MASK(types[x][y]);
             }
+            x2 = x - 1;
+            y2 = y - 1;
+            neighbors.getCellLocation(x2, y2);
+            matchTests[i][numMatchTests].x    = x2 + 1;
+            matchTests[i][numMatchTests].y    = y2 + 1;
+            matchTests[i][numMatchTests].mask = mask;
+            numMatchTests++;
+         }
+      }
+   }
+}
+
+
+// Determine cell neighborhood match.
+bool Gene::matchNeighborhood(Neighborhood *neighbors)
+{
+   int       i;
+   Cell      *cell;
+   MatchTest *test;
+
+   test = matchTests[neighbors->getOrientationIndex()];
+   for (i = 0; i < numMatchTests; i++, test++)
+   {
+      cell = neighbors->cells[test->x][test->y];
+      if (cell == NULL)
+      {
+         return(false);
+      }
+      if (test->mask == 0)
+      {
+         if (cell->typeMask != 0)
+         {
+            return(false);
          }
       }
+      else if ((cell->typeMask & test->mask) == 0)
+      {
+         return(false);
+      }
    }
    return(true);
 }
@@ -232,10 +248,46 @@ Gene *Gene::duplicate()
    gene->tendency    = tendency;
    gene->delay       = delay;
    gene->duration    = duration;
+   gene->compile();
    return(gene);
 }
 
 
+// Gene matches same neighborhoods as given gene?
+bool Gene::matchesSame(Gene *gene)
+{
+   int x, y;
+
+   for (x = 0; x < 3; x++)
+   {
+      for (y = 0; y < 3; y++)
+      {
+         if (gene->types[x][y] != types[x][y])
+         {
+            return(false);
+         }
+      }
+   }
+   return(true);
+}
+
+
+// Gene identical to given gene?
+bool Gene::equals(Gene *gene)
+{
+   return(matchesSame(gene) &&
+          (gene->action == action) &&
+          (gene->dx == dx) && (gene->dy == dy) &&
+          (gene->type == type) &&
+          (gene->orientation.direction == orientation.direction) &&
+          (gene->orientation.mirrored == orientation.mirrored) &&
+          (gene->strength == strength) &&
+          (gene->tendency == tendency) &&
+          (gene->delay == delay) &&
+          (gene->duration == duration));
+}
+
+
 // Read gene.
 Gene *Gene::read(FILE *fp)
 {
@@ -272,6 +324,7 @@ Gene *Gene::read(FILE *fp)
    gene->tendency = atof(buf);
    fscanf(fp, "%d", &gene->delay);
    fscanf(fp, "%d", &gene->duration);
+   gene->compile();
    return(gene);
 }
 
@@ -309,6 +362,75 @@ void Gene::write(FILE *fp, Gene *gene)
 }
 
 
+// Pack gene.
+void Gene::pack(Packed *packed)
+{
+   int x, y;
+
+   for (x = 0; x < 3; x++)
+   {
+      for (y = 0; y < 3; y++)
+      {
+         packed->types[x][y] = types[x][y];
+      }
+   }
+   packed->action    = action;
+   packed->dx        = dx;
+   packed->dy        = dy;
+   packed->type      = type;
+   packed->direction = orientation.direction;
+   if (orientation.mirrored)
+   {
+      packed->mirrored = 1;
+   }
+   else
+   {
+      packed->mirrored = 0;
+   }
+   packed->strength = strength;
+   packed->tendency = tendency;
+   packed->delay    = delay;
+   packed->duration = duration;
+}
+
+
+// Unpack gene.
+Gene *Gene::unpack(Packed *packed)
+{
+   int x, y;
+
+   Gene *gene = new Gene();
+
+   assert(gene != NULL);
+   for (x = 0; x < 3; x++)
+   {
+      for (y = 0; y < 3; y++)
+      {
+         gene->types[x][y] = packed->types[x][y];
+      }
+   }
+   gene->action                = packed->action;
+   gene->dx                    = packed->dx;
+   gene->dy                    = packed->dy;
+   gene->type                  = packed->type;
+   gene->orientation.direction = packed->direction;
+   if (packed->mirrored == 1)
+   {
+      gene->orientation.mirrored = true;
+   }
+   else
+   {
+      gene->orientation.mirrored = false;
+   }
+   gene->strength = packed->strength;
+   gene->tendency = packed->tendency;
+   gene->delay    = packed->delay;
+   gene->duration = packed->duration;
+   gene->compile();
+   return(gene);
+}
+
+
 // Print gene.
 void Gene::print()
 {
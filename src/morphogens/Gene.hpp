@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include "../base/Cell.hpp"
+#include "../util/Random.hpp"
 
 // Gene.
 class Gene
@@ -68,7 +69,11 @@ public:
    void clear();
 
    // Randomize gene.
-   void randomize();
+   void randomize(Random *random);
+
+   // Compile matching types into per-orientation cell mask tests.
+   // Must be called after the matching types are changed.
+   void compile();
 
    // Determine neighborhood match.
    bool matchNeighborhood(Neighborhood *neighborhood);
@@ -76,13 +81,48 @@ public:
    // Duplicate gene.
    Gene *duplicate();
 
+   // Gene matches same neighborhoods as given gene?
+   bool matchesSame(Gene *gene);
+
+   // Gene identical to given gene?
+   bool equals(Gene *gene);
+
    // Read gene.
    static Gene *read(FILE *fp);
 
    // Write gene.
    static void write(FILE *fp, Gene *gene);
 
+   // Packed gene: gene values in fixed binary form, for
+   // transfer between processes.
+   struct Packed
+   {
+      int    types[3][3];
+      int    action, dx, dy, type;
+      int    direction, mirrored;
+      double strength, tendency;
+      int    delay, duration;
+   };
+
+   // Pack gene.
+   void pack(Packed *packed);
+
+   // Unpack gene.
+   static Gene *unpack(Packed *packed);
+
    // Print gene.
    void print();
+
+private:
+
+   // Compiled matching test: neighborhood cell location and
+   // type mask bits required of it (zero if cell must be empty).
+   struct MatchTest
+   {
+      int          x, y;
+      unsigned int mask;
+   };
+   MatchTest matchTests[NUM_ORIENTATIONS][9];
+   int       numMatchTests;
 };
 #endif
@@ -25,6 +25,7 @@ Genome::Genome()
       genes[i] = new Gene();
       assert(genes[i] != NULL);
    }
+   compile();
 }
 
 
@@ -36,15 +37,16 @@ Genome::~Genome()
 
 
 // Randomize genes.
-void Genome::randomize()
+void Genome::randomize(Random *random)
 {
    for (int i = 0; i < NUM_GENES; i++)
    {
       if (genes[i] != NULL)
       {
-         genes[i]->randomize();
+         genes[i]->randomize(random);
       }
    }
+   compile();
 }
 
 
@@ -59,6 +61,32 @@ void Genome::clear()
          genes[i] = NULL;
       }
    }
+   compile();
+}
+
+
+// Compile genes for matching and index them by center type.
+void Genome::compile()
+{
+   int i, type;
+
+   for (type = 0; type < MAX_CENTER_TYPES; type++)
+   {
+      numCenterGenes[type] = 0;
+   }
+   for (i = 0; i < NUM_GENES; i++)
+   {
+      if (genes[i] != NULL)
+      {
+         genes[i]->compile();
+         type = genes[i]->types[1][1];
+         if ((type >= 0) && (type < MAX_CENTER_TYPES))
+         {
+            centerGenes[type][numCenterGenes[type]] = i;
+            numCenterGenes[type]++;
+         }
+      }
+   }
 }
 
 
@@ -73,10 +101,80 @@ Genome *Genome::duplicate()
    {
       genome->genes[i] = genes[i]->duplicate();
    }
+   genome->compile();
    return(genome);
 }
 
 
+// Fold bytes into FNV-1a hash.
+static GENOME_HASH hashBytes(GENOME_HASH hash, void *bytes, int size)
+{
+   unsigned char *b = (unsigned char *)bytes;
+
+   for (int i = 0; i < size; i++)
+   {
+      hash ^= b[i];
+      hash *= 0x100000001B3ULL;
+   }
+   return(hash);
+}
+
+
+// Hash genome content: identical genomes have identical hashes.
+GENOME_HASH Genome::hash()
+{
+   GENOME_HASH hash;
+   Gene        *gene;
+   int         i, direction;
+   bool        mirrored;
+
+   hash = 0xCBF29CE484222325ULL;
+   for (i = 0; i < NUM_GENES; i++)
+   {
+      hash = hashBytes(hash, &i, sizeof(i));
+      if ((gene = genes[i]) == NULL)
+      {
+         continue;
+      }
+      direction = gene->orientation.direction;
+      mirrored  = gene->orientation.mirrored;
+      hash      = hashBytes(hash, gene->types, sizeof(gene->types));
+      hash      = hashBytes(hash, &gene->action, sizeof(gene->action));
+      hash      = hashBytes(hash, &gene->dx, sizeof(gene->dx));
+      hash      = hashBytes(hash, &gene->dy, sizeof(gene->dy));
+      hash      = hashBytes(hash, &gene->type, sizeof(gene->type));
+      hash      = hashBytes(hash, &direction, sizeof(direction));
+      hash      = hashBytes(hash, &mirrored, sizeof(mirrored));
+      hash      = hashBytes(hash, &gene->strength, sizeof(gene->strength));
+      hash      = hashBytes(hash, &gene->tendency, sizeof(gene->tendency));
+      hash      = hashBytes(hash, &gene->delay, sizeof(gene->delay));
+      hash      = hashBytes(hash, &gene->duration, sizeof(gene->duration));
+   }
+   return(hash);
+}
+
+
+// Genome has the same genes as given genome?
+bool Genome::equals(Genome *genome)
+{
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      if ((genes[i] == NULL) || (genome->genes[i] == NULL))
+      {
+         if (genes[i] != genome->genes[i])
+         {
+            return(false);
+         }
+      }
+      else if (!genes[i]->equals(genome->genes[i]))
+      {
+         return(false);
+      }
+   }
+   return(true);
+}
+
+
 // Read genome.
 Genome *Genome::read(FILE *fp)
 {
@@ -88,6 +186,7 @@ Genome *Genome::read(FILE *fp)
    {
       genome->genes[i] = Gene::read(fp);
    }
+   genome->compile();
    return(genome);
 }
 
@@ -104,6 +203,32 @@ void Genome::write(FILE *fp, Genome *genome)
 }
 
 
+// Pack genome into NUM_GENES packed genes.
+void Genome::pack(Gene::Packed *packed)
+{
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      genes[i]->pack(&packed[i]);
+   }
+}
+
+
+// Unpack genome from NUM_GENES packed genes.
+Genome *Genome::unpack(Gene::Packed *packed)
+{
+   Genome *genome = new Genome();
+
+   assert(genome != NULL);
+   genome->clear();
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      genome->genes[i] = Gene::unpack(&packed[i]);
+   }
+   genome->compile();
+   return(genome);
+}
+
+
 // Print genome.
 void Genome::print()
 {
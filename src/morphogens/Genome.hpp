@@ -24,7 +24,15 @@
 #include "Gene.hpp"
 
 // Parameters.
-#define NUM_GENES    27
+#define NUM_GENES           27
+#define MAX_CENTER_TYPES    MAX_MASK_TYPES
+
+// Genome content hash.
+#ifdef WIN32
+typedef unsigned __int64      GENOME_HASH;
+#else
+typedef unsigned long long    GENOME_HASH;
+#endif
 
 // Genome.
 class Genome
@@ -33,6 +41,10 @@ public:
 
    Gene *genes[NUM_GENES];
 
+   // Indices of genes matching each neighborhood center type.
+   int centerGenes[MAX_CENTER_TYPES][NUM_GENES];
+   int numCenterGenes[MAX_CENTER_TYPES];
+
    // Constructor.
    Genome();
 
@@ -40,20 +52,36 @@ public:
    ~Genome();
 
    // Randomize genome.
-   void randomize();
+   void randomize(Random *random);
 
    // Clear genes.
    void clear();
 
+   // Compile genes for matching and index them by center type.
+   // Must be called after genes are changed.
+   void compile();
+
    // Duplicate genome.
    Genome *duplicate();
 
+   // Hash genome content: identical genomes have identical hashes.
+   GENOME_HASH hash();
+
+   // Genome has the same genes as given genome?
+   bool equals(Genome *genome);
+
    // Read genome.
    static Genome *read(FILE *fp);
 
    // Write genome.
    static void write(FILE *fp, Genome *genome);
 
+   // Pack genome into NUM_GENES packed genes.
+   void pack(Gene::Packed *packed);
+
+   // Unpack genome from NUM_GENES packed genes.
+   static Genome *unpack(Gene::Packed *packed);
+
    // Print genome.
    void print();
 };
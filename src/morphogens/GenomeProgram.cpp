@@ -0,0 +1,218 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+
+/*
+ * Genome program.
+ * The genes of a Maxwell genome compiled, for each neighborhood center
+ * type and orientation, into the list of actions they can perform.
+ * Genes that can never act are removed (or kept without an action
+ * when gene matches are traced) and action parameters that depend
+ * only on the orientation are resolved in advance.
+ */
+
+#include "GenomeProgram.hpp"
+#include <assert.h>
+#include MORPHOGEN_INCLUDE
+
+// Constructor.
+GenomeProgram::GenomeProgram()
+{
+   int type, i;
+
+   for (type = 0; type < MAX_CENTER_TYPES; type++)
+   {
+      for (i = 0; i < NUM_ORIENTATIONS; i++)
+      {
+         instructions[type][i]    = NULL;
+         numInstructions[type][i] = 0;
+      }
+   }
+}
+
+
+// Destructor.
+GenomeProgram::~GenomeProgram()
+{
+   clear();
+}
+
+
+// Compile genome: genome genes must be compiled.
+void GenomeProgram::compile(Genome *genome)
+{
+   int         type, i, j, n, g;
+   Orientation orientation;
+   Instruction *instruction;
+
+   clear();
+   for (type = 0; type < MAX_CENTER_TYPES; type++)
+   {
+      n = genome->numCenterGenes[type];
+      if (n == 0)
+      {
+         continue;
+      }
+      for (i = 0; i < NUM_ORIENTATIONS; i++)
+      {
+         instructions[type][i] = new Instruction[n];
+         assert(instructions[type][i] != NULL);
+         orientation.direction = i % 8;
+         orientation.mirrored  = (i >= 8);
+         for (j = 0; j < n; j++)
+         {
+            g           = genome->centerGenes[type][j];
+            instruction = &instructions[type][i][numInstructions[type][i]];
+            if (compile(genome->genes[g], orientation, instruction))
+            {
+               instruction->index = g;
+               numInstructions[type][i]++;
+            }
+#if (TRACE_GENES == 1)
+            else
+            {
+               // Keep gene to trace its matches.
+               instruction->gene   = genome->genes[g];
+               instruction->index  = g;
+               instruction->action = NO_ACTION;
+               numInstructions[type][i]++;
+            }
+#endif
+         }
+      }
+   }
+}
+
+
+// Clear program.
+void GenomeProgram::clear()
+{
+   int type, i;
+
+   for (type = 0; type < MAX_CENTER_TYPES; type++)
+   {
+      for (i = 0; i < NUM_ORIENTATIONS; i++)
+      {
+         if (instructions[type][i] != NULL)
+         {
+            delete [] instructions[type][i];
+            instructions[type][i] = NULL;
+         }
+         numInstructions[type][i] = 0;
+      }
+   }
+}
+
+
+// Compile gene action for particle orientation.
+// Return false if gene cannot act.
+bool GenomeProgram::compile(Gene *gene, Orientation& orientation,
+                            Instruction *instruction)
+{
+   int          x, y;
+   Neighborhood neighbors;
+   Orientation  steps;
+
+   if (gene->action == -1)
+   {
+      return(false);
+   }
+   neighbors.transform(orientation);
+   x = gene->dx;
+   y = gene->dy;
+   neighbors.getCellLocation(x, y);
+   instruction->gene       = gene;
+   instruction->action     = gene->action;
+   instruction->x          = x;
+   instruction->y          = y;
+   instruction->type       = gene->type;
+   instruction->targetType = -1;
+   instruction->dx         = instruction->dy = 0;
+
+   switch (gene->action)
+   {
+   case CREATE_ACTION:
+      // Cannot create food.
+      if (gene->type == FOOD_TYPE)
+      {
+         return(false);
+      }
+      instruction->orientation.direction =
+         orientation.aim(gene->orientation.direction);
+      instruction->orientation.mirrored =
+         orientation.getMirrorX2(gene->orientation.mirrored);
+      break;
+
+   case BOND_ACTION:
+      break;
+
+   case SET_TYPE_ACTION:
+      // Cannot change to food.
+      if (gene->type == FOOD_TYPE)
+      {
+         return(false);
+      }
+
+      // Target must be in neighborhood.
+      if ((x < -1) || (x > 1) || (y < -1) || (y > 1))
+      {
+         return(false);
+      }
+      instruction->targetType = gene->types[x + 1][y + 1];
+      if (instruction->targetType < 0)
+      {
+         return(false);
+      }
+      break;
+
+   case ORIENT_ACTION:
+      instruction->orientation.direction =
+         orientation.aim(gene->orientation.direction);
+      instruction->orientation.mirrored =
+         orientation.getMirrorX2(gene->orientation.mirrored);
+      break;
+
+   case UNBOND_ACTION:
+      break;
+
+   case DESTROY_ACTION:
+      // Cannot destroy obstacle.
+      if (gene->type == OBSTACLE_TYPE)
+      {
+         return(false);
+      }
+      break;
+
+   case GRAPPLE_ACTION:
+      if ((x < -1) || (x > 1) || (y < -1) || (y > 1))
+      {
+         return(false);
+      }
+      steps.direction = gene->orientation.direction;
+      steps.mirrored  = orientation.mirrored;
+      Neighborhood::getDxy(x, y, steps, instruction->dx, instruction->dy);
+      break;
+
+   case PROPEL_ACTION:
+      instruction->orientation.direction =
+         orientation.aim(gene->orientation.direction);
+      break;
+
+   default:
+      return(false);
+   }
+   return(true);
+}
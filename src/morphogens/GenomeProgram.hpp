@@ -0,0 +1,73 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+
+/*
+ * Genome program.
+ * The genes of a Maxwell genome compiled, for each neighborhood center
+ * type and orientation, into the list of actions they can perform.
+ * Genes that can never act are removed (or kept without an action
+ * when gene matches are traced) and action parameters that depend
+ * only on the orientation are resolved in advance.
+ */
+
+#ifndef __GENOME_PROGRAM__
+#define __GENOME_PROGRAM__
+
+#include "Genome.hpp"
+
+// Genome program.
+class GenomeProgram
+{
+public:
+
+   // Compiled gene action.
+   struct Instruction
+   {
+      Gene        *gene;        // gene to match
+      int         index;        // gene index in genome
+      int         action;       // action index (NO_ACTION if cannot act)
+      int         x, y;         // target cell location
+      int         type;         // action type parameter
+      int         targetType;   // current type of target (set type)
+      Orientation orientation;  // aimed orientation (create, orient, propel)
+      int         dx, dy;       // movement offsets (grapple)
+   };
+
+   // Instructions by center type and orientation index.
+   Instruction *instructions[MAX_CENTER_TYPES][NUM_ORIENTATIONS];
+   int         numInstructions[MAX_CENTER_TYPES][NUM_ORIENTATIONS];
+
+   // Constructor.
+   GenomeProgram();
+
+   // Destructor.
+   ~GenomeProgram();
+
+   // Compile genome: genome genes must be compiled.
+   void compile(Genome *genome);
+
+   // Clear program.
+   void clear();
+
+private:
+
+   // Compile gene action for particle orientation.
+   // Return false if gene cannot act.
+   bool compile(Gene *gene, Orientation& orientation,
+                Instruction *instruction);
+};
+#endif
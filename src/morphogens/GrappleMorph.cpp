@@ -99,6 +99,9 @@ void GrappleMorph::morph(Cell *cell)
             dy2 = dy + POSITION(cell->y) - POSITION(particle1->vPosition.y);
             particle2->vPosition.x = particle1->vPosition.x + dx2;
             particle2->vPosition.y = particle1->vPosition.y + dy2;
+
+            // Particle moved within its body.
+            mechanics->revision++;
          }
       }
    }
@@ -118,5 +121,6 @@ Signal *GrappleMorph::createGrappleSignal(Particle *particle,
    parameters[3] = (void *)targetType;
    Signal *signal = new Signal(GRAPPLE->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(4, 1);
    return(signal);
 }
@@ -14,6 +14,8 @@
  * DISCLAIMED.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "Maxwell.hpp"
 #include "../base/Mechanics.hpp"
 #include "../util/Random.hpp"
@@ -27,6 +29,19 @@ void Maxwell::setGenome(Genome *genome)
       delete this->genome;
    }
    this->genome = genome;
+
+   // Genes may have been modified directly.
+   genome->compile();
+   program.compile(genome);
+#if (MEMOIZE_SIGNALS == 1)
+   clearSignalCache();
+#endif
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      geneFired[i] = false;
+   }
+#endif
 }
 
 
@@ -60,6 +75,27 @@ Maxwell::Maxwell()
    // Create genome.
    genome = new Genome();
    assert(genome != NULL);
+   program.compile(genome);
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      geneFired[i] = false;
+   }
+#endif
+
+#if (CACHE_MAXWELL == 1)
+   cacheValid     = false;
+   cachedRevision = 0;
+   cachedBody     = NULL;
+   cachedVariance = -1;
+#endif
+
+#if (MEMOIZE_SIGNALS == 1)
+   // Create signal cache.
+   signalCache = new SignalMemo[SIGNAL_CACHE_SIZE];
+   assert(signalCache != NULL);
+   clearSignalCache();
+#endif
 
 #if (FORAGING_MOVEMENT_SCREEN == 1)
    // Create movement test neighborhood.
@@ -76,15 +112,15 @@ Maxwell::Maxwell()
    }
    particle = new Particle(BODY_SIDE_TYPE);
    assert(particle != NULL);
-   testNeighbors.cells[0][1]->particles.push_front(particle);
+   testNeighbors.cells[0][1]->addParticle(particle);
    particle = new Particle(BODY_CORNER_TYPE);
    assert(particle != NULL);
    particle->orientation.direction = NORTHEAST;
-   testNeighbors.cells[1][1]->particles.push_front(particle);
+   testNeighbors.cells[1][1]->addParticle(particle);
    particle = new Particle(BODY_SIDE_TYPE);
    assert(particle != NULL);
    particle->orientation.direction = EAST;
-   testNeighbors.cells[1][0]->particles.push_front(particle);
+   testNeighbors.cells[1][0]->addParticle(particle);
 #endif
 }
 
@@ -99,6 +135,9 @@ Maxwell::~Maxwell()
    delete orientMorph;
    delete typeMorph;
    delete genome;
+#if (MEMOIZE_SIGNALS == 1)
+   delete [] signalCache;
+#endif
 
 #if (FORAGING_MOVEMENT_SCREEN == 1)
    // Delete movement test neighborhood.
@@ -123,6 +162,57 @@ Maxwell::~Maxwell()
 }
 
 
+// Save genome and gene trace in binary form (false if not written).
+bool Maxwell::saveState(FILE *fp)
+{
+   Gene::Packed genes[NUM_GENES];
+
+   memset(genes, 0, sizeof(genes));
+   genome->pack(genes);
+   if (fwrite(genes, sizeof(Gene::Packed), NUM_GENES, fp) != NUM_GENES)
+   {
+      return(false);
+   }
+#if (TRACE_GENES == 1)
+   if (fwrite(geneFired, sizeof(bool), NUM_GENES, fp) != NUM_GENES)
+   {
+      return(false);
+   }
+#endif
+   return(true);
+}
+
+
+// Load state saved in binary form (false if unreadable).
+bool Maxwell::loadState(FILE *fp)
+{
+   Gene::Packed genes[NUM_GENES];
+
+#if (TRACE_GENES == 1)
+   bool fired[NUM_GENES];
+#endif
+
+   if (fread(genes, sizeof(Gene::Packed), NUM_GENES, fp) != NUM_GENES)
+   {
+      return(false);
+   }
+#if (TRACE_GENES == 1)
+   if (fread(fired, sizeof(bool), NUM_GENES, fp) != NUM_GENES)
+   {
+      return(false);
+   }
+#endif
+   setGenome(Genome::unpack(genes));
+#if (TRACE_GENES == 1)
+   for (int i = 0; i < NUM_GENES; i++)
+   {
+      geneFired[i] = fired[i];
+   }
+#endif
+   return(true);
+}
+
+
 // Initialize.
 void Maxwell::init(Mechanics *mechanics)
 {
@@ -136,6 +226,10 @@ void Maxwell::init(Mechanics *mechanics)
    propelMorph->init(mechanics);
    orientMorph->init(mechanics);
    typeMorph->init(mechanics);
+
+#if (CACHE_MAXWELL == 1)
+   cacheValid = false;
+#endif
 }
 
 
@@ -212,12 +306,12 @@ bool Maxwell::load(Body **bodies, int numBodies)
    }
 
    // Determine number of patches.
-   n  = Random::nextInt(MAX_FOOD_PATCHES - MIN_FOOD_PATCHES + 1);
+   n  = mechanics->random.nextInt(MAX_FOOD_PATCHES - MIN_FOOD_PATCHES + 1);
    n += MIN_FOOD_PATCHES;
    for (i = 0; i < n; i++)
    {
       // Determine radius.
-      r  = Random::nextInt(MAX_PATCH_RADIUS - MIN_PATCH_RADIUS + 1);
+      r  = mechanics->random.nextInt(MAX_PATCH_RADIUS - MIN_PATCH_RADIUS + 1);
       r += MIN_PATCH_RADIUS;
 
       // Map food patch.
@@ -225,8 +319,8 @@ bool Maxwell::load(Body **bodies, int numBodies)
       x = WIDTH / 2;
       y = HEIGHT / 2;
 #else
-      x = Random::nextInt(WIDTH);
-      y = Random::nextInt(HEIGHT);
+      x = mechanics->random.nextInt(WIDTH);
+      y = mechanics->random.nextInt(HEIGHT);
 #endif
       mapPatch(FOOD_TYPE, x, y, r);
    }
@@ -258,7 +352,7 @@ bool Maxwell::load(Body **bodies, int numBodies)
    }
 
    // Determine number of poison particles.
-   n  = Random::nextInt(MAX_POISON_PARTICLES - MIN_POISON_PARTICLES + 1);
+   n  = mechanics->random.nextInt(MAX_POISON_PARTICLES - MIN_POISON_PARTICLES + 1);
    n += MIN_POISON_PARTICLES;
    for (i = 0; i < n; i++)
    {
@@ -281,18 +375,18 @@ bool Maxwell::load(Body **bodies, int numBodies)
    }
 
    // Determine number of walls.
-   n  = Random::nextInt(MAX_OBSTACLE_WALLS - MIN_OBSTACLE_WALLS + 1);
+   n  = mechanics->random.nextInt(MAX_OBSTACLE_WALLS - MIN_OBSTACLE_WALLS + 1);
    n += MIN_OBSTACLE_WALLS;
    for (i = 0; i < n; i++)
    {
       // Determine wall length.
-      l  = Random::nextInt(MAX_WALL_LENGTH - MIN_WALL_LENGTH + 1);
+      l  = mechanics->random.nextInt(MAX_WALL_LENGTH - MIN_WALL_LENGTH + 1);
       l += MIN_WALL_LENGTH;
 
       // Map wall.
-      x = Random::nextInt(WIDTH);
-      y = Random::nextInt(HEIGHT);
-      switch (Random::nextInt(4))
+      x = mechanics->random.nextInt(WIDTH);
+      y = mechanics->random.nextInt(HEIGHT);
+      switch (mechanics->random.nextInt(4))
       {
       case 0:
          for (int j = 0; j < l; j++)
@@ -387,13 +481,87 @@ bool Maxwell::placeBody(Body *body, float maxVelocity)
 {
    int      i;
    Particle *particle;
-   double   dx, dy, x, y;
+
+#if (SCANNED_PLACEMENT == 1)
+   int    x, y, w, h, n;
+   double minX, minY;
+
+   // Get body extent.
+   particle = body->particles;
+   if (particle == NULL)
+   {
+      return(false);
+   }
+   minX = particle->vPosition.x;
+   minY = particle->vPosition.y;
+   for (particle = body->particles; particle != NULL;
+        particle = particle->next)
+   {
+      if (particle->vPosition.x < minX)
+      {
+         minX = particle->vPosition.x;
+      }
+      if (particle->vPosition.y < minY)
+      {
+         minY = particle->vPosition.y;
+      }
+   }
+   w = h = 0;
+   for (particle = body->particles; particle != NULL;
+        particle = particle->next)
+   {
+      x = (int)(particle->vPosition.x - minX);
+      y = (int)(particle->vPosition.y - minY);
+      if (x >= w)
+      {
+         w = x + 1;
+      }
+      if (y >= h)
+      {
+         h = y + 1;
+      }
+   }
+
+   // Scan for anchor cells where body fits on free cells.
+   // Every anchor is checked against every particle, O(area * particles),
+   // which for a body of 8 particles takes under 50us, against about
+   // 3ms for a single morph cycle: placement is done only when a world
+   // is loaded, so no free-space index of the map is kept.
+   n = 0;
+   for (x = 0; x <= WIDTH - w; x++)
+   {
+      for (y = 0; y <= HEIGHT - h; y++)
+      {
+         if (fitBody(body, minX, minY, x, y))
+         {
+            anchors[n] = (x * HEIGHT) + y;
+            n++;
+         }
+      }
+   }
+   if (n == 0)
+   {
+      return(false);
+   }
+
+   // Place body at random anchor.
+   i = anchors[mechanics->random.nextInt(n)];
+   x = i / HEIGHT;
+   y = i % HEIGHT;
+   for (particle = body->particles; particle != NULL;
+        particle = particle->next)
+   {
+      particle->vPosition.x = POSITION((double)x + (particle->vPosition.x - minX));
+      particle->vPosition.y = POSITION((double)y + (particle->vPosition.y - minY));
+   }
+#else
+   double dx, dy, x, y;
 
    dx = dy = 0.0;
    for (i = 0; i < MAX_PLACEMENT_TRIES; i++)
    {
-      dx = WIDTH * Random::nextDouble();
-      dy = HEIGHT * Random::nextDouble();
+      dx = WIDTH * mechanics->random.nextDouble();
+      dy = HEIGHT * mechanics->random.nextDouble();
       for (particle = body->particles; particle != NULL;
            particle = particle->next)
       {
@@ -419,17 +587,18 @@ bool Maxwell::placeBody(Body *body, float maxVelocity)
       particle->vPosition.x = POSITION(particle->vPosition.x + dx);
       particle->vPosition.y = POSITION(particle->vPosition.y + dy);
    }
+#endif
 
    // Randomize body velocity.
    if (maxVelocity > 0.0f)
    {
-      body->vVelocity.x = Random::nextDouble() * maxVelocity;
-      if (Random::nextBoolean())
+      body->vVelocity.x = mechanics->random.nextDouble() * maxVelocity;
+      if (mechanics->random.nextBoolean())
       {
          body->vVelocity.x = -body->vVelocity.x;
       }
-      body->vVelocity.y = Random::nextDouble() * -maxVelocity;
-      if (Random::nextBoolean())
+      body->vVelocity.y = mechanics->random.nextDouble() * -maxVelocity;
+      if (mechanics->random.nextBoolean())
       {
          body->vVelocity.y = -body->vVelocity.y;
       }
@@ -446,32 +615,52 @@ bool Maxwell::placeBody(Body *body, float maxVelocity)
 }
 
 
-// Map patch.
-void Maxwell::mapPatch(int type, int x, int y, int radius)
+#if (SCANNED_PLACEMENT == 1)
+// Body with given extent minimum fits on free cells at anchor?
+bool Maxwell::fitBody(Body *body, double minX, double minY, int x, int y)
 {
-   if (radius == 0)
-   {
-      return;
-   }
-   if (map[x][y] == -1)
-   {
-      map[x][y] = type;
-   }
-   if (x > 0)
-   {
-      mapPatch(type, x - 1, y, radius - 1);
-   }
-   if (x < WIDTH - 1)
-   {
-      mapPatch(type, x + 1, y, radius - 1);
-   }
-   if (y > 0)
+   Particle *particle;
+   int      x2, y2;
+
+   for (particle = body->particles; particle != NULL;
+        particle = particle->next)
    {
-      mapPatch(type, x, y - 1, radius - 1);
+      x2 = x + (int)(particle->vPosition.x - minX);
+      y2 = y + (int)(particle->vPosition.y - minY);
+      if (map[x2][y2] != -1)
+      {
+         return(false);
+      }
    }
-   if (y < HEIGHT - 1)
+   return(true);
+}
+
+
+#endif
+
+// Map patch: cells within radius steps of center.
+void Maxwell::mapPatch(int type, int x, int y, int radius)
+{
+   int x2, y2, d;
+
+   for (x2 = x - radius + 1; x2 < x + radius; x2++)
    {
-      mapPatch(type, x, y + 1, radius - 1);
+      if ((x2 < 0) || (x2 >= WIDTH))
+      {
+         continue;
+      }
+      d = radius - 1 - abs(x2 - x);
+      for (y2 = y - d; y2 <= y + d; y2++)
+      {
+         if ((y2 < 0) || (y2 >= HEIGHT))
+         {
+            continue;
+         }
+         if (map[x2][y2] == -1)
+         {
+            map[x2][y2] = type;
+         }
+      }
    }
 }
 
@@ -485,14 +674,18 @@ void Maxwell::preMorph()
 Emission *Maxwell::signal(Neighborhood *neighbors)
 {
    Cell     *cell;
-   int      i, x, y, dx, dy, action, type;
+   int      i, n, orientation;
    Particle *particle;
    Gene     *gene;
    Signal   *signal;
    Emission *emissionList, *emission;
 
+   GenomeProgram::Instruction *instructions, *instruction;
+#if (MEMOIZE_SIGNALS == 1)
+   SignalMemo *memo;
+#endif
+
    std::list<Particle *>::const_iterator listItr;
-   Orientation orientation;
 
    // Process particles in neighborhood origin.
    emissionList = NULL;
@@ -502,116 +695,97 @@ Emission *Maxwell::signal(Neighborhood *neighbors)
    {
       particle = *listItr;
 
+      // Only genes centered on the particle type can act.
+      if ((particle->type < 0) || (particle->type >= MAX_CENTER_TYPES))
+      {
+         continue;
+      }
+
       // Transform neighborhood to particle orientation.
       neighbors->transform(particle->orientation);
+      orientation  = neighbors->getOrientationIndex();
+      instructions = program.instructions[particle->type][orientation];
+
+#if (MEMOIZE_SIGNALS == 1)
+      // Get instructions matching neighborhood.
+      memo = getSignalMemo(neighbors, particle);
+      n    = memo->numInstructions;
+#else
+      n = program.numInstructions[particle->type][orientation];
+#endif
 
       // Perform actions determined by genes.
-      for (i = 0; i < NUM_GENES; i++)
+      for (i = 0; i < n; i++)
       {
-         gene = genome->genes[i];
-
-         // Get action.
+#if (MEMOIZE_SIGNALS == 1)
+         instruction = &instructions[memo->instructions[i]];
+         gene        = instruction->gene;
+#else
+         instruction = &instructions[i];
+         gene        = instruction->gene;
          if (!gene->matchNeighborhood(neighbors))
          {
             continue;
          }
-         if (gene->types[1][1] != particle->type)
-         {
-            continue;
-         }
-         if ((action = gene->action) == -1)
+#endif
+
+#if (TRACE_GENES == 1)
+         // Trace match; skip gene that cannot act.
+         geneFired[instruction->index] = true;
+         if (instruction->action == NO_ACTION)
          {
             continue;
          }
-         x = gene->dx;
-         y = gene->dy;
-         neighbors->getCellLocation(x, y);
+#endif
 
          // Execute action.
          signal = NULL;
-         switch (action)
+         switch (instruction->action)
          {
          case CREATE_ACTION:
-            // Cannot create food.
-            if (gene->type == FOOD_TYPE)
-            {
-               continue;
-            }
-            orientation.direction =
-               particle->orientation.aim(gene->orientation.direction);
-            orientation.mirrored =
-               particle->orientation.getMirrorX2(gene->orientation.mirrored);
             signal = createMorph->createCreateSignal(particle,
-                                                     orientation, gene->type);
+                                                     instruction->orientation, instruction->type);
             break;
 
          case BOND_ACTION:
-            signal = bondMorph->createBondSignal(particle, gene->type);
+            signal = bondMorph->createBondSignal(particle, instruction->type);
             break;
 
          case SET_TYPE_ACTION:
-            // Cannot change to food.
-            if (gene->type == FOOD_TYPE)
-            {
-               continue;
-            }
-
-            // Target must be in neighborhood.
-            if ((x < -1) || (x > 1) || (y < -1) || (y > 1))
-            {
-               continue;
-            }
-            type = gene->types[x + 1][y + 1];
-            if (type < 0)
-            {
-               continue;
-            }
-            signal = typeMorph->createTypeSignal(gene->type, type);
+            signal = typeMorph->createTypeSignal(instruction->type,
+                                                 instruction->targetType);
             break;
 
          case ORIENT_ACTION:
-            orientation.direction =
-               particle->orientation.aim(gene->orientation.direction);
-            orientation.mirrored =
-               particle->orientation.getMirrorX2(gene->orientation.mirrored);
-            signal = orientMorph->createOrientSignal(orientation, gene->type);
+            signal = orientMorph->createOrientSignal(instruction->orientation,
+                                                     instruction->type);
             break;
 
          case UNBOND_ACTION:
-            signal = bondMorph->createUnbondSignal(particle, gene->type);
+            signal = bondMorph->createUnbondSignal(particle, instruction->type);
             break;
 
          case DESTROY_ACTION:
-            // Cannot destroy obstacle.
-            if (gene->type == OBSTACLE_TYPE)
-            {
-               continue;
-            }
-            signal = createMorph->createDestroySignal(gene->type);
+            signal = createMorph->createDestroySignal(instruction->type);
             break;
 
          case GRAPPLE_ACTION:
-            if ((x < -1) || (x > 1) || (y < -1) || (y > 1))
-            {
-               continue;
-            }
-            orientation.direction = gene->orientation.direction;
-            orientation.mirrored  = particle->orientation.mirrored;
-            Neighborhood::getDxy(x, y, orientation, dx, dy);
-            signal = grappleMorph->createGrappleSignal(particle, dx, dy, gene->type);
+            signal = grappleMorph->createGrappleSignal(particle,
+                                                       instruction->dx, instruction->dy, instruction->type);
             break;
 
          case PROPEL_ACTION:
             signal = propelMorph->createPropelSignal(particle,
-                                                     particle->orientation.aim(gene->orientation.direction),
-                                                     gene->strength, gene->tendency, gene->type);
+                                                     instruction->orientation.direction,
+                                                     gene->strength, gene->tendency, instruction->type);
             break;
          }
 
          // Queue signal emission to target cell.
          if (signal != NULL)
          {
-            emission = new Emission(signal, x, y, gene->delay, gene->duration);
+            emission = new Emission(signal, instruction->x, instruction->y,
+                                    gene->delay, gene->duration);
             assert(emission != NULL);
             emission->next = emissionList;
             emissionList   = emission;
@@ -624,6 +798,93 @@ Emission *Maxwell::signal(Neighborhood *neighbors)
 }
 
 
+#if (MEMOIZE_SIGNALS == 1)
+
+// Clear signal cache.
+void Maxwell::clearSignalCache()
+{
+   for (int i = 0; i < SIGNAL_CACHE_SIZE; i++)
+   {
+      signalCache[i].valid = false;
+   }
+}
+
+
+// Get cached matching instructions for particle in transformed neighborhood.
+Maxwell::SignalMemo *Maxwell::getSignalMemo(Neighborhood *neighbors,
+                                            Particle     *particle)
+{
+   int          i, n, x, y, orientation;
+   unsigned int masks[9], hash;
+   SignalMemo   *memo;
+
+   GenomeProgram::Instruction *instructions;
+
+   // Compute neighborhood signature.
+   // A missing cell is marked with a mask no cell can have.
+   orientation = neighbors->getOrientationIndex();
+   hash        = 2166136261u;
+   hash        = (hash ^ (unsigned int)particle->type) * 16777619u;
+   hash        = (hash ^ (unsigned int)orientation) * 16777619u;
+   for (x = i = 0; x < 3; x++)
+   {
+      for (y = 0; y < 3; y++, i++)
+      {
+         if (neighbors->cells[x][y] == NULL)
+         {
+            masks[i] = ~0u;
+         }
+         else
+         {
+            masks[i] = neighbors->cells[x][y]->typeMask;
+         }
+         hash = (hash ^ masks[i]) * 16777619u;
+      }
+   }
+
+   // Cached?
+   memo = &signalCache[hash & (SIGNAL_CACHE_SIZE - 1)];
+   if (memo->valid && (memo->type == particle->type) &&
+       (memo->orientation == orientation))
+   {
+      for (i = 0; i < 9; i++)
+      {
+         if (memo->masks[i] != masks[i])
+         {
+            break;
+         }
+      }
+      if (i == 9)
+      {
+         return(memo);
+      }
+   }
+
+   // Replace entry with instructions matching neighborhood.
+   memo->valid       = true;
+   memo->type        = particle->type;
+   memo->orientation = orientation;
+   for (i = 0; i < 9; i++)
+   {
+      memo->masks[i] = masks[i];
+   }
+   memo->numInstructions = 0;
+   instructions          = program.instructions[particle->type][orientation];
+   n = program.numInstructions[particle->type][orientation];
+   for (i = 0; i < n; i++)
+   {
+      if (instructions[i].gene->matchNeighborhood(neighbors))
+      {
+         memo->instructions[memo->numInstructions] = i;
+         memo->numInstructions++;
+      }
+   }
+   return(memo);
+}
+
+
+#endif
+
 // Morph.
 void Maxwell::morph(Cell *cell)
 {
@@ -640,44 +901,43 @@ void Maxwell::morph(Cell *cell)
 // Post-morph processing.
 void Maxwell::postMorph()
 {
-   Body     *body;
-   Particle *particle, *removeParticle;
-   bool     done;
+   Particle *particle, *poison;
+   int      i;
+
+   Mechanics::Contact *contact;
 
    // Propel bodies.
    propelMorph->postMorph();
 
    // Kill particles hit by poison particles.
-   done = false;
-   while (!done)
+   // Contacts of removed particles are cleared by mechanics.
+   for (contact = mechanics->contacts; contact != NULL; contact = contact->next)
    {
-      done = true;
-      for (body = mechanics->bodies; body != NULL; body = body->next)
+      for (i = 0; i < 2; i++)
       {
-         for (particle = body->particles; particle != NULL;
-              particle = particle->next)
+         if (i == 0)
          {
-            if ((particle->type == BODY_SIDE_TYPE) ||
-                (particle->type == BODY_CORNER_TYPE))
-            {
-               if ((particle->collide != NULL) &&
-                   mechanics->isValidParticle(particle->collide) &&
-                   (particle->collide->type == POISON_TYPE))
-               {
-                  removeParticle = particle;
-                  done           = false;
-                  break;
-               }
-            }
+            particle = contact->particle1;
+            poison   = contact->particle2;
+         }
+         else
+         {
+            particle = contact->particle2;
+            poison   = contact->particle1;
          }
-         if (!done)
+         if ((particle == NULL) || (poison == NULL))
          {
             break;
          }
-      }
-      if (!done)
-      {
-         mechanics->removeParticle(body, removeParticle);
+         if ((particle->type == BODY_SIDE_TYPE) ||
+             (particle->type == BODY_CORNER_TYPE))
+         {
+            if ((particle->collide == poison) &&
+                (poison->type == POISON_TYPE))
+            {
+               mechanics->removeParticle(particle->body, particle);
+            }
+         }
       }
    }
 }
@@ -691,7 +951,7 @@ double Maxwell::getFitness()
    double fitness;
 
    // Maxwell is "alive"?
-   body = findMaxwell(variance);
+   body = getMaxwell(variance);
    if ((body == NULL) || (variance > MIN_VARIANCE))
    {
       return(0.0);
@@ -705,6 +965,92 @@ double Maxwell::getFitness()
 }
 
 
+// Get "best" Maxwell and its variance, rescanning bodies only
+// after a structural change.
+Body *Maxwell::getMaxwell(int& variance)
+{
+#if (CACHE_MAXWELL == 1)
+   if (!cacheValid || (cachedRevision != mechanics->revision))
+   {
+      cachedBody     = findMaxwell(cachedVariance);
+      cachedRevision = mechanics->revision;
+      cacheValid     = true;
+   }
+   variance = cachedVariance;
+   return(cachedBody);
+#else
+   return(findMaxwell(variance));
+#endif
+}
+
+
+// Can genome make food, by creating it or by changing
+// other particles into it?
+bool Maxwell::makesFood()
+{
+   int types[3] = { FOOD_TYPE, DIGESTING_FOOD_TYPE, DIGESTED_FOOD_TYPE };
+
+   return(makesTypes(types, 3));
+}
+
+
+// Can genome make body particles, by creating them or by
+// changing other particles into them?
+bool Maxwell::makesBody()
+{
+   int types[2] = { BODY_CORNER_TYPE, BODY_SIDE_TYPE };
+
+   return(makesTypes(types, 2));
+}
+
+
+// Can genome make particles of the given types, by creating them
+// or by changing particles of other types into them?
+bool Maxwell::makesTypes(int *types, int numTypes)
+{
+   int i, j, k, t;
+   bool made, target;
+
+   GenomeProgram::Instruction *instruction;
+
+   for (i = 0; i < MAX_CENTER_TYPES; i++)
+   {
+      for (j = 0; j < NUM_ORIENTATIONS; j++)
+      {
+         for (k = 0; k < program.numInstructions[i][j]; k++)
+         {
+            instruction = &program.instructions[i][j][k];
+            made        = target = false;
+            for (t = 0; t < numTypes; t++)
+            {
+               if (instruction->type == types[t])
+               {
+                  made = true;
+               }
+               if (instruction->targetType == types[t])
+               {
+                  target = true;
+               }
+            }
+            if (!made)
+            {
+               continue;
+            }
+            if (instruction->action == CREATE_ACTION)
+            {
+               return(true);
+            }
+            if ((instruction->action == SET_TYPE_ACTION) && !target)
+            {
+               return(true);
+            }
+         }
+      }
+   }
+   return(false);
+}
+
+
 // Find "best" Maxwell: if found, return body (NULL if not found)
 // and measure of its "variance" from ideal.
 // Note: Maxwell's sides can be temporarily removed to admit food.
@@ -963,7 +1309,7 @@ Body *Maxwell::findMaxwell(int& bestVariance)
 
 
 // Create a viable gene.
-void Maxwell::createViableGene(Gene *gene, int action)
+void Maxwell::createViableGene(Gene *gene, int action, Random *random)
 {
    int x, y;
 
@@ -971,23 +1317,23 @@ void Maxwell::createViableGene(Gene *gene, int action)
    gene->clear();
 
    // Choose a target cell/particle.
-   x = Random::nextInt(3);
-   y = Random::nextInt(3);
-   gene->types[x][y] = Random::nextInt(NUM_PARTICLE_TYPES);
+   x = random->nextInt(3);
+   y = random->nextInt(3);
+   gene->types[x][y] = random->nextInt(NUM_PARTICLE_TYPES);
    gene->strength    = Gene::STRENGTH_QUANTUM;
    gene->dx          = x - 1;
    gene->dy          = y - 1;
 
    // Choose default parameters.
    gene->type = gene->types[x][y];
-   gene->orientation.direction = Random::nextInt(8);
+   gene->orientation.direction = random->nextInt(8);
    gene->tendency = Gene::TENDENCY_QUANTUM;
 
    switch (gene->action = action)
    {
    case CREATE_ACTION:
       gene->types[x][y] = Gene::EMPTY_CELL;
-      gene->type        = Random::nextInt(NUM_PARTICLE_TYPES);
+      gene->type        = random->nextInt(NUM_PARTICLE_TYPES);
       break;
 
    case BOND_ACTION:
@@ -1000,7 +1346,7 @@ void Maxwell::createViableGene(Gene *gene, int action)
       {
          while (true)
          {
-            gene->type = Random::nextInt(NUM_PARTICLE_TYPES);
+            gene->type = random->nextInt(NUM_PARTICLE_TYPES);
             if ((gene->type != FOOD_TYPE) && (gene->type !=
                                               gene->types[x][y]))
             {
@@ -1011,7 +1357,7 @@ void Maxwell::createViableGene(Gene *gene, int action)
       break;
 
    case ORIENT_ACTION:
-      gene->orientation.mirrored = Random::nextBoolean();
+      gene->orientation.mirrored = random->nextBoolean();
       break;
 
    case UNBOND_ACTION:
@@ -1022,12 +1368,13 @@ void Maxwell::createViableGene(Gene *gene, int action)
 
    case GRAPPLE_ACTION:
 
-      gene->orientation.mirrored = Random::nextBoolean();
+      gene->orientation.mirrored = random->nextBoolean();
       break;
 
    case PROPEL_ACTION:
       break;
    }
+   gene->compile();
 }
 
 
@@ -53,6 +53,7 @@
 #include "OrientMorph.hpp"
 #include "TypeMorph.hpp"
 #include "Genome.hpp"
+#include "GenomeProgram.hpp"
 
 // Actions:
 // Create/destroy, set type, bond/unbond,
@@ -66,6 +67,7 @@
 #define GRAPPLE_ACTION         6
 #define PROPEL_ACTION          7
 #define NUM_ACTIONS            8
+#define NO_ACTION              (-1)
 
 // Particle types.
 #define NUM_PARTICLE_TYPES     8
@@ -117,6 +119,31 @@
 // Test genome for foraging movement.
 #define FORAGING_MOVEMENT_SCREEN         0
 
+// Signal memoization: instructions matching a neighborhood are cached by
+// its signature (cell type masks, particle type and orientation).
+#define MEMOIZE_SIGNALS                  1
+#if (MEMOIZE_SIGNALS == 1)
+#define SIGNAL_CACHE_SIZE                4096 // power of 2
+#endif
+
+// Maxwell cache: the best body and its variance are kept until the
+// mechanics structure revision changes, and are then found again by a
+// full findMaxwell scan. Fitness reads between structural changes are
+// O(1); each structural change still costs a full scan of all bodies.
+// Bodies moving as a whole cannot change the result; a particle moved
+// within its body (as by grappling) advances the revision.
+#define CACHE_MAXWELL                    1
+
+// Scanned body placement: the map is scanned for every anchor cell
+// where the body fits on free cells, and the body is placed at one of
+// them drawn at random, instead of retrying random positions.
+#define SCANNED_PLACEMENT                1
+
+// Gene tracing: genes are marked as they match neighborhoods, so that
+// genes that never matched during an evaluation are known. Genes that
+// cannot act are kept in the genome program to trace their matches.
+#define TRACE_GENES                      1
+
 // Maximum body placement tries.
 #define MAX_PLACEMENT_TRIES              1000
 
@@ -140,12 +167,26 @@ public:
    // Genome.
    Genome *genome;
 
+   // Genome compiled for signaling.
+   GenomeProgram program;
+
+#if (TRACE_GENES == 1)
+   // Genes that have matched a neighborhood since the genome was set.
+   bool geneFired[NUM_GENES];
+#endif
+
    // Set genome
    void setGenome(Genome *genome);
 
    // Create genome.
    Genome *createGenome();
 
+   // Save genome and gene trace in binary form.
+   bool saveState(FILE *fp);
+
+   // Load state saved in binary form (false if unreadable).
+   bool loadState(FILE *fp);
+
    // Constructor.
    Maxwell();
 
@@ -173,8 +214,19 @@ public:
    // Get fitness.
    double getFitness();
 
+   // Get "best" Maxwell body and its variance from ideal.
+   Body *getMaxwell(int& variance);
+
+   // Can genome make food, by creating it or by changing
+   // other particles into it? Energy is then unbounded.
+   bool makesFood();
+
+   // Can genome make body particles, by creating them or by
+   // changing other particles into them?
+   bool makesBody();
+
    // Create a viable gene.
-   void createViableGene(Gene *, int action);
+   void createViableGene(Gene *, int action, Random *random);
 
 #if (FORAGING_MOVEMENT_SCREEN == 1)
    // Gene produces mobility (self-propulsion)?
@@ -187,12 +239,49 @@ private:
    // and measure of its "variance" from ideal.
    Body *findMaxwell(int& variance);
 
+   // Can genome make particles of the given types, by creating them
+   // or by changing particles of other types into them?
+   bool makesTypes(int *types, int numTypes);
+
+#if (CACHE_MAXWELL == 1)
+   // Cached Maxwell as of mechanics structure revision.
+   bool         cacheValid;
+   unsigned int cachedRevision;
+   Body         *cachedBody;
+   int          cachedVariance;
+#endif
+
    // Place body.
    bool placeBody(Body *, float maxVelocity);
 
    // Body placement tools.
    int map[WIDTH][HEIGHT];
    void mapPatch(int type, int x, int y, int radius);
+#if (SCANNED_PLACEMENT == 1)
+   int anchors[WIDTH * HEIGHT];
+   bool fitBody(Body *body, double minX, double minY, int x, int y);
+#endif
+
+#if (MEMOIZE_SIGNALS == 1)
+   // Signal cache entry: indices of program instructions
+   // matching neighborhood.
+   struct SignalMemo
+   {
+      bool         valid;
+      unsigned int masks[9];
+      int          type;
+      int          orientation;
+      int          numInstructions;
+      int          instructions[NUM_GENES];
+   };
+   SignalMemo *signalCache;
+
+   // Clear signal cache.
+   void clearSignalCache();
+
+   // Get cached matching instructions for particle in transformed neighborhood.
+   SignalMemo *getSignalMemo(Neighborhood *neighbors, Particle *particle);
+#endif
 
 #if (FORAGING_MOVEMENT_SCREEN == 1)
    // Movement test neighborhood.
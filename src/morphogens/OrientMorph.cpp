@@ -111,5 +111,6 @@ Signal *OrientMorph::createOrientSignal(Orientation orientation, int targetType)
    parameters[2] = (void *)targetType;
    Signal *signal = new Signal(ORIENT->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(3, 0);
    return(signal);
 }
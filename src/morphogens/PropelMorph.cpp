@@ -17,6 +17,8 @@
 /*
  * Propulsion morphogen - body propulsion.
  * PROPEL signal parameter: propulsion values.
+ * The source particle follows the payload so that identical
+ * propulsions from different particles can be coalesced.
  */
 
 #include "PropelMorph.hpp"
@@ -76,22 +78,23 @@ void PropelMorph::morph(Cell *cell)
          }
 
          // Signal applies to this particle?
-         type = (unsigned long)(emission->signal->parameters[3]);
+         type = (unsigned long)(emission->signal->parameters[2]);
          if (particle->type != type)
          {
             continue;
          }
 
          // Get signal payload.
-         direction = (unsigned long)(emission->signal->parameters[1]);
-         force     = (double)((unsigned long)emission->signal->parameters[2]) *
+         direction = (unsigned long)(emission->signal->parameters[0]);
+         force     = (double)((unsigned long)emission->signal->parameters[1]) *
                      Gene::STRENGTH_QUANTUM;
 
          // Create vector.
-         propulsion           = new struct Particle::Propulsion;
-         propulsion->weight   = emission->signal->strength;
-         propulsion->delay    = emission->delay;
-         propulsion->duration = emission->duration;
+         propulsion               = new struct Particle::Propulsion;
+         propulsion->weight       = emission->signal->strength;
+         propulsion->multiplicity = emission->multiplicity;
+         propulsion->delay        = emission->delay;
+         propulsion->duration     = emission->duration;
          switch (direction)
          {
          case NORTH:
@@ -150,7 +153,7 @@ void PropelMorph::postMorph()
 
    for (body = mechanics->bodies; body != NULL; body = body->next)
    {
-      body->propel();
+      body->propel(&mechanics->random);
    }
 }
 
@@ -162,11 +165,12 @@ Signal *PropelMorph::createPropelSignal(Particle *particle, int direction,
    void **parameters = new void *[4];
 
    assert(parameters != NULL);
-   parameters[0] = (void *)particle;
-   parameters[1] = (void *)direction;
-   parameters[2] = (void *)((int)(force / Gene::STRENGTH_QUANTUM));
-   parameters[3] = (void *)targetType;
-   Signal *signal = new Signal(PROPEL->clone(), parameters, weight);
+   parameters[0] = (void *)direction;
+   parameters[1] = (void *)((int)(force / Gene::STRENGTH_QUANTUM));
+   parameters[2] = (void *)targetType;
+   parameters[3] = (void *)particle;
+   Signal *signal = new Signal(PROPEL->clone(), parameters, 3, weight);
    assert(signal != NULL);
+   signal->setLayout(4, 1 << 3);
    return(signal);
 }
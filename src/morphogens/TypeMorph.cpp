@@ -20,6 +20,7 @@
  */
 
 #include "TypeMorph.hpp"
+#include "../base/Mechanics.hpp"
 
 // Constructor.
 TypeMorph::TypeMorph()
@@ -76,6 +77,7 @@ void TypeMorph::morph(Cell *cell)
 
             // Change particle type.
             particle->type = deltaType;
+            mechanics->revision++;
          }
       }
    }
@@ -92,5 +94,6 @@ Signal *TypeMorph::createTypeSignal(int deltaType, int targetType)
    parameters[1] = (void *)targetType;
    Signal *signal = new Signal(TYPE->clone(), parameters);
    assert(signal != NULL);
+   signal->setLayout(2, 0);
    return(signal);
 }
@@ -0,0 +1,151 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Convert test body file between text and binary forms.
+ * The input file may be in either form; the output is binary
+ * unless -text is given. A binary body reads back exactly as the
+ * input body read; a text body keeps the particle order but its
+ * bonds are relisted in text order.
+ * Usage: BodyConvert [-text] <input body file name> <output body file name>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../base/Mechanics.hpp"
+#include "../base/Body.hpp"
+
+// Reverse body particle list.
+void reverse(Body *);
+
+int main(int argc, char *argv[])
+{
+   FILE      *fp;
+   Mechanics mechanics;
+   Body      **bodies;
+   int       i, numBodies;
+   bool      binary, text, written;
+
+   if ((argc == 4) && (strcmp(argv[1], "-text") == 0))
+   {
+      text = true;
+   }
+   else if (argc == 3)
+   {
+      text = false;
+   }
+   else
+   {
+      fprintf(stderr, "Usage: BodyConvert [-text] <input body file name> <output body file name>\n");
+      return(1);
+   }
+
+   // Read bodies.
+   if ((fp = fopen(argv[argc - 2], "rb")) == NULL)
+   {
+      fprintf(stderr, "Cannot open body file %s\n", argv[argc - 2]);
+      return(1);
+   }
+   binary = Body::readHeader(fp, numBodies);
+   if (!binary && (fscanf(fp, "%d", &numBodies) != 1))
+   {
+      numBodies = -1;
+   }
+   if (numBodies < 0)
+   {
+      fprintf(stderr, "Invalid body file %s\n", argv[argc - 2]);
+      fclose(fp);
+      return(1);
+   }
+   bodies = new Body *[numBodies + 1];
+   assert(bodies != NULL);
+   for (i = 0; i < numBodies; i++)
+   {
+      if (binary)
+      {
+         bodies[i] = Body::readBinary(fp, &mechanics);
+      }
+      else
+      {
+         bodies[i] = Body::read(fp, &mechanics);
+      }
+      if (bodies[i] == NULL)
+      {
+         fprintf(stderr, "Invalid body %d in file %s\n", i, argv[argc - 2]);
+         fclose(fp);
+         return(1);
+      }
+   }
+   fclose(fp);
+
+   // Write bodies.
+   if ((fp = fopen(argv[argc - 1], "wb")) == NULL)
+   {
+      fprintf(stderr, "Cannot open body file %s\n", argv[argc - 1]);
+      return(1);
+   }
+   if (text)
+   {
+      fprintf(fp, "%d\n", numBodies);
+      for (i = 0; i < numBodies; i++)
+      {
+         // Text bodies read back in reverse particle order.
+         reverse(bodies[i]);
+         Body::write(fp, bodies[i]);
+      }
+      written = (ferror(fp) == 0);
+   }
+   else
+   {
+      written = Body::writeHeader(fp, numBodies);
+      for (i = 0; written && i < numBodies; i++)
+      {
+         written = Body::writeBinary(fp, bodies[i]);
+      }
+   }
+   if ((fclose(fp) != 0) || !written)
+   {
+      fprintf(stderr, "Cannot write body file %s\n", argv[argc - 1]);
+      return(1);
+   }
+   printf("Converted %d bodies from %s to %s\n", numBodies,
+          argv[argc - 2], argv[argc - 1]);
+
+   for (i = 0; i < numBodies; i++)
+   {
+      delete bodies[i];
+   }
+   delete [] bodies;
+   return(0);
+}
+
+
+// Reverse body particle list.
+void reverse(Body *body)
+{
+   Particle *particle, *particles;
+
+   particles = NULL;
+   while (body->particles != NULL)
+   {
+      particle        = body->particles;
+      body->particles = particle->next;
+      particle->next  = particles;
+      particles       = particle;
+   }
+   body->particles = particles;
+}
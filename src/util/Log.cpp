@@ -22,7 +22,7 @@ char Log:: logFileNameBuf[LOG_FILE_NAMESZ + 1];
 char *Log::logFileName = DEFAULT_LOG_FILE_NAME;
 
 // Message composition buffer.
-char Log::messageBuf[MESSAGE_SIZE + 1];
+THREAD_LOCAL char Log::messageBuf[MESSAGE_SIZE + 1];
 
 FILE *Log::logfp     = NULL;
 bool Log:: logOpened = false;
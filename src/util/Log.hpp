@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "ThreadLocal.h"
 #ifdef UNIX
 #include <unistd.h>
 #endif
@@ -42,8 +43,8 @@ public:
    static char *logFileName;
    static void setLogFileName(char *name);
 
-   // Message composition buffer.
-   static char messageBuf[MESSAGE_SIZE + 1];
+   // Message composition buffer (per thread).
+   static THREAD_LOCAL char messageBuf[MESSAGE_SIZE + 1];
 
    // Log error message.
    static void logError(char *message);
@@ -0,0 +1,121 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Play recorded trajectories as text: for each frame, its step and
+ * particle and bond counts, then a line per particle (type, orientation
+ * index and position) and per bond (particle indices).
+ * Given a step, only that frame of each trajectory is played.
+ * Usage: PlayTrajectory <trajectory file name> [<step>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../base/Trajectory.hpp"
+
+// Print frame.
+void print(Trajectory *);
+
+int main(int argc, char *argv[])
+{
+   FILE       *fp;
+   Trajectory *trajectory;
+   int        i, step;
+   bool       played;
+
+   if ((argc != 2) && (argc != 3))
+   {
+      fprintf(stderr, "Usage: PlayTrajectory <trajectory file name> [<step>]\n");
+      return(1);
+   }
+   if ((fp = fopen(argv[1], "rb")) == NULL)
+   {
+      fprintf(stderr, "Cannot open trajectory file %s\n", argv[1]);
+      return(1);
+   }
+   step = -1;
+   if (argc == 3)
+   {
+      step = atoi(argv[2]);
+   }
+
+   // Play trajectories in turn: each starts after the previous ends.
+   for (i = 0; ; i++)
+   {
+      trajectory = new Trajectory(fp, false);
+      assert(trajectory != NULL);
+      if (!trajectory->valid)
+      {
+         delete trajectory;
+         break;
+      }
+      printf("Trajectory %d\n", i);
+      if (step == -1)
+      {
+         while (trajectory->play())
+         {
+            print(trajectory);
+         }
+      }
+      else
+      {
+         if (trajectory->seek(step))
+         {
+            print(trajectory);
+         }
+
+         // Play to end of trajectory.
+         while (trajectory->play())
+         {
+         }
+      }
+      played = trajectory->valid;
+      delete trajectory;
+      if (!played)
+      {
+         fprintf(stderr, "Invalid trajectory %d in file %s\n", i, argv[1]);
+         fclose(fp);
+         return(1);
+      }
+   }
+   fclose(fp);
+   return(0);
+}
+
+
+// Print frame.
+void print(Trajectory *trajectory)
+{
+   int i;
+
+   Trajectory::ParticleState *particle;
+
+   printf("Step %d: particles=%d, bonds=%d\n", trajectory->step,
+          trajectory->numParticles, trajectory->numBonds);
+   for (i = 0; i < trajectory->numParticles; i++)
+   {
+      particle = &trajectory->particles[i];
+      printf("%d %d %f %f\n", particle->type, particle->orientation,
+             (double)particle->x / (double)TRAJECTORY_SCALE,
+             (double)particle->y / (double)TRAJECTORY_SCALE);
+   }
+   for (i = 0; i < trajectory->numBonds; i++)
+   {
+      printf("%d-%d\n", trajectory->bonds[i].particle1,
+             trajectory->bonds[i].particle2);
+   }
+}
@@ -20,78 +20,108 @@
 
 #include "Random.hpp"
 
-#ifdef UNIX
-#include <stdlib.h>
-#endif
-#ifdef WIN32
-#include <windows.h>
-#endif
+// Rotate left.
+#define ROTATE(x, k)    (((x) << (k)) | ((x) >> (64 - (k))))
+
+// SplitMix64 step: used to expand a key into generator state.
+static RANDOM_WORD splitMix(RANDOM_WORD& x)
+{
+   RANDOM_WORD z;
+
+   x += 0x9E3779B97F4A7C15ULL;
+   z  = x;
+   z  = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z  = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return(z ^ (z >> 31));
+}
+
+
+// Constructors.
+Random::Random()
+{
+   setRand(0);
+}
+
+
+Random::Random(long seed)
+{
+   setRand(seed);
+}
+
 
 // Set random seed.
 void Random::setRand(long seed)
 {
-#ifdef UNIX
-   srand48(seed);
-#endif
-#ifdef WIN32
-   srand(seed);
-#endif
+   setKey((RANDOM_WORD)seed);
+}
+
+
+// Split independent stream.
+Random Random::split(RANDOM_WORD stream)
+{
+   Random      random;
+   RANDOM_WORD x;
+
+   x = key ^ (stream * 0xD1B54A32D192ED03ULL);
+   random.setKey(splitMix(x));
+   return(random);
 }
 
 
 // Random boolean.
 bool Random::nextBoolean()
 {
-   int r;
-
-#ifdef UNIX
-   r = lrand48() % 2;
-#endif
-#ifdef WIN32
-   r = rand() % 2;
-#endif
-   if (r == 1)
-   {
-      return(true);
-   }
-   else
-   {
-      return(false);
-   }
+   return((next() >> 63) == 1);
 }
 
 
 // Random double >= 0.0 && < 1.0
 double Random::nextDouble()
 {
-#ifdef UNIX
-   return(drand48());
-#endif
-#ifdef WIN32
-   return((double)rand() / (double)RAND_MAX);
-#endif
+   return((double)(next() >> 11) * (1.0 / 9007199254740992.0));
 }
 
 
-// Random integer.
+// Random non-negative integer < 2^31.
 long Random::nextInt()
 {
-#ifdef UNIX
-   return(lrand48());
-#endif
-#ifdef WIN32
-   return(rand());
-#endif
+   return((long)(next() >> 33));
 }
 
 
 // Random integer modulus given value.
 long Random::nextInt(int modulus)
 {
-#ifdef UNIX
-   return(lrand48() % modulus);
-#endif
-#ifdef WIN32
-   return(rand() % modulus);
-#endif
+   return((long)(((next() >> 32) * (RANDOM_WORD)modulus) >> 32));
+}
+
+
+// Set stream key and initialize state from it.
+void Random::setKey(RANDOM_WORD key)
+{
+   RANDOM_WORD x;
+
+   this->key = key;
+   x         = key;
+   state[0]  = splitMix(x);
+   state[1]  = splitMix(x);
+   state[2]  = splitMix(x);
+   state[3]  = splitMix(x);
+}
+
+
+// Next 64 random bits.
+RANDOM_WORD Random::next()
+{
+   RANDOM_WORD result, t;
+
+   result    = ROTATE(state[1] * 5, 7) * 9;
+   t         = state[1] << 17;
+   state[2] ^= state[0];
+   state[3] ^= state[1];
+   state[1] ^= state[2];
+   state[0] ^= state[3];
+   state[2] ^= t;
+   state[3]  = ROTATE(state[3], 45);
+   return(result);
 }
@@ -16,28 +16,58 @@
 
 /*
  * Random numbers.
+ * A xoshiro256** generator. Each world owns its generator, and
+ * independent streams are split from a generator by stream number
+ * (for example, a world's loading and each member's morphing), so
+ * results do not depend on the order in which worlds are run.
  */
 
 #ifndef __RANDOM__
 #define __RANDOM__
 
+#ifdef WIN32
+typedef unsigned __int64      RANDOM_WORD;
+#else
+typedef unsigned long long    RANDOM_WORD;
+#endif
+
 class Random
 {
 public:
 
+   // Constructors.
+   Random();
+   Random(long seed);
+
    // Set random seed.
-   static void setRand(long seed);
+   void setRand(long seed);
+
+   // Split independent stream.
+   // The same generator seed and stream give the same stream.
+   Random split(RANDOM_WORD stream);
 
    // Random boolean.
-   static bool nextBoolean();
+   bool nextBoolean();
 
    // Random double >= 0.0 && < 1.0
-   static double nextDouble();
+   double nextDouble();
 
-   // Random integer.
-   static long nextInt();
+   // Random non-negative integer < 2^31.
+   long nextInt();
 
    // Random integer modulus given value.
-   static long nextInt(int modulus);
+   long nextInt(int modulus);
+
+private:
+
+   // Stream key and generator state.
+   RANDOM_WORD key;
+   RANDOM_WORD state[4];
+
+   // Set stream key and initialize state from it.
+   void setKey(RANDOM_WORD key);
+
+   // Next 64 random bits.
+   RANDOM_WORD next();
 };
 #endif
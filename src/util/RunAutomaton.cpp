@@ -0,0 +1,194 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Run the test genome on test bodies for a number of morphs, starting
+ * from a new world or from a saved automaton state, and optionally
+ * save the state reached. A run saved and resumed matches the same
+ * run made without stopping.
+ * Usage: RunAutomaton -steps <number of morphs>
+ *    (-bodies <test body file name> [-seed <random seed>] |
+ *     -load <state file name>)
+ *    [-save <state file name>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../base/Automaton.hpp"
+#include "../base/Body.hpp"
+#include "Log.hpp"
+#include "Random.hpp"
+#include "TestGenome.hpp"
+
+// Usage.
+const char *Usage = "Usage: RunAutomaton -steps <number of morphs>\n\t(-bodies <test body file name> [-seed <random seed>] |\n\t -load <state file name>)\n\t[-save <state file name>]\n";
+
+// Load new world from test bodies (false if not loaded).
+bool loadBodies(Automaton *, char *bodiesFileName, long seed);
+
+int main(int argc, char *argv[])
+{
+   int       i, steps;
+   long      seed;
+   char      *bodiesFileName, *loadFileName, *saveFileName;
+   FILE      *fp;
+   Automaton *automaton;
+   bool      loaded;
+
+   Log::LOGGING_FLAG = NO_LOG;
+
+   steps          = -1;
+   seed           = 1;
+   bodiesFileName = loadFileName = saveFileName = NULL;
+   for (i = 1; i < argc - 1; i += 2)
+   {
+      if (strcmp(argv[i], "-steps") == 0)
+      {
+         steps = atoi(argv[i + 1]);
+      }
+      else if (strcmp(argv[i], "-bodies") == 0)
+      {
+         bodiesFileName = argv[i + 1];
+      }
+      else if (strcmp(argv[i], "-seed") == 0)
+      {
+         seed = atol(argv[i + 1]);
+      }
+      else if (strcmp(argv[i], "-load") == 0)
+      {
+         loadFileName = argv[i + 1];
+      }
+      else if (strcmp(argv[i], "-save") == 0)
+      {
+         saveFileName = argv[i + 1];
+      }
+      else
+      {
+         break;
+      }
+   }
+   if ((i != argc) || (steps < 0) ||
+       ((bodiesFileName == NULL) == (loadFileName == NULL)))
+   {
+      fprintf(stderr, "%s", Usage);
+      return(1);
+   }
+
+   // Start new world or load saved state.
+   automaton = new Automaton();
+   assert(automaton != NULL);
+   if (bodiesFileName != NULL)
+   {
+      if (!loadBodies(automaton, bodiesFileName, seed))
+      {
+         return(1);
+      }
+   }
+   else
+   {
+      if ((fp = fopen(loadFileName, "rb")) == NULL)
+      {
+         fprintf(stderr, "Cannot open state file %s\n", loadFileName);
+         return(1);
+      }
+      loaded = automaton->loadState(fp);
+      fclose(fp);
+      if (!loaded)
+      {
+         fprintf(stderr, "Invalid state file %s\n", loadFileName);
+         return(1);
+      }
+   }
+
+   // Run.
+   for (i = 0; i < steps; i++)
+   {
+      automaton->morph();
+   }
+   printf("Steps=%d, particles=%d\n", steps, automaton->mechanics.numParticles);
+
+   // Save state.
+   if (saveFileName != NULL)
+   {
+      if (((fp = fopen(saveFileName, "wb")) == NULL) ||
+          !automaton->saveState(fp) || (fclose(fp) != 0))
+      {
+         fprintf(stderr, "Cannot save to state file %s\n", saveFileName);
+         return(1);
+      }
+   }
+   delete automaton;
+   return(0);
+}
+
+
+// Load new world from test bodies (false if not loaded).
+bool loadBodies(Automaton *automaton, char *bodiesFileName, long seed)
+{
+   FILE   *fp;
+   Body   **bodies;
+   int    i, numBodies;
+   bool   binary;
+   Random random(seed);
+
+   if ((fp = fopen(bodiesFileName, "rb")) == NULL)
+   {
+      fprintf(stderr, "Cannot open body file %s\n", bodiesFileName);
+      return(false);
+   }
+   binary = Body::readHeader(fp, numBodies);
+   if (!binary && (fscanf(fp, "%d", &numBodies) != 1))
+   {
+      numBodies = -1;
+   }
+   if (numBodies < 0)
+   {
+      fprintf(stderr, "Invalid body file %s\n", bodiesFileName);
+      fclose(fp);
+      return(false);
+   }
+   bodies = new Body *[numBodies + 1];
+   assert(bodies != NULL);
+   for (i = 0; i < numBodies; i++)
+   {
+      if (binary)
+      {
+         bodies[i] = Body::readBinary(fp, &automaton->mechanics);
+      }
+      else
+      {
+         bodies[i] = Body::read(fp, &automaton->mechanics);
+      }
+      if (bodies[i] == NULL)
+      {
+         fprintf(stderr, "Invalid body %d in file %s\n", i, bodiesFileName);
+         fclose(fp);
+         return(false);
+      }
+   }
+   fclose(fp);
+
+   automaton->morphogen.setGenome(new TestGenome(&random));
+   automaton->mechanics.random.setRand(seed);
+   if (!automaton->morphogen.load(bodies, numBodies))
+   {
+      fprintf(stderr, "Cannot place test bodies\n");
+      return(false);
+   }
+   return(true);
+}
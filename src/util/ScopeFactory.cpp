@@ -20,7 +20,7 @@
 
 #include "ScopeFactory.hpp"
 
-int ScopeFactory::next = 0;
+THREAD_LOCAL int ScopeFactory::next = 0;
 
 // New scope.
 Scope *ScopeFactory::newScope()
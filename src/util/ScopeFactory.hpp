@@ -22,6 +22,7 @@
 #define __SCOPE_FACTORY__
 
 #include "Scope.hpp"
+#include "ThreadLocal.h"
 
 class ScopeFactory
 {
@@ -35,6 +36,7 @@ public:
 
 private:
 
-   static int next;
+   // Next scope (per thread).
+   static THREAD_LOCAL int next;
 };
 #endif
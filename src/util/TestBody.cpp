@@ -30,7 +30,8 @@
 Body *bodies;
 
 // Functions.
-void create(), save(char *);
+void create();
+bool save(char *);
 void addParticle(Body *, Particle *);
 void bondParticles(Particle *, Particle *);
 
@@ -54,7 +55,10 @@ int main(int argc, char *argv[])
 
    // Save bodies.
    printf("Saving bodies to %s...\n", fileName);
-   save(fileName);
+   if (!save(fileName))
+   {
+      return(1);
+   }
 
    printf("Done.\n");
    return(0);
@@ -203,25 +207,40 @@ void bondParticles(Particle *particle1, Particle *particle2)
 }
 
 
-// Save test bodies to file.
-void save(char *fileName)
+// Save test bodies to file (false if not saved).
+bool save(char *fileName)
 {
    FILE *fp;
    Body *body;
    int  count;
+   bool written;
 
-   if ((fp = fopen(fileName, "w")) == NULL)
+   if ((fp = fopen(fileName, "wb")) == NULL)
    {
-      fprintf(stderr, "Cannot open test body file %s", fileName);
-      return;
+      fprintf(stderr, "Cannot open test body file %s\n", fileName);
+      return(false);
    }
    for (body = bodies, count = 0; body != NULL; body = body->next, count++)
    {
    }
+#if (BINARY_BODIES == 1)
+   written = Body::writeHeader(fp, count);
+   for (body = bodies; written && body != NULL; body = body->next)
+   {
+      written = Body::writeBinary(fp, body);
+   }
+#else
    fprintf(fp, "%d\n", count);
    for (body = bodies; body != NULL; body = body->next)
    {
       Body::write(fp, body);
    }
-   fclose(fp);
+   written = (ferror(fp) == 0);
+#endif
+   if ((fclose(fp) != 0) || !written)
+   {
+      fprintf(stderr, "Cannot write test body file %s\n", fileName);
+      return(false);
+   }
+   return(true);
 }
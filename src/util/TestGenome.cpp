@@ -20,7 +20,7 @@
 #include <assert.h>
 
 // Constructor.
-TestGenome::TestGenome()
+TestGenome::TestGenome(Random *random)
 {
    int  n = 0;
    Gene *gene;
@@ -378,13 +378,13 @@ TestGenome::TestGenome()
 #if (FORAGING_GENES_INITIALIZATION == RANDOM_FORAGING_VALUES)
    gene = genes[n];
    n++;
-   gene->randomize();
+   gene->randomize(random);
    gene = genes[n];
    n++;
-   gene->randomize();
+   gene->randomize(random);
    gene = genes[n];
    n++;
-   gene->randomize();
+   gene->randomize(random);
 #endif
 
 #if (FORAGING_GENES_INITIALIZATION == CLEAR_FORAGING_VALUES)
@@ -434,6 +434,9 @@ TestGenome::TestGenome()
    gene->orientation.direction = EAST;
    gene->orientation.mirrored  = false;
    gene->strength              = 0.1;
+
+   // Index modified genes.
+   compile();
 }
 
 
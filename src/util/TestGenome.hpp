@@ -29,7 +29,8 @@ class TestGenome : public Genome
 public:
 
    // Constructor.
-   TestGenome();
+   // Random numbers are used for randomly initialized genes.
+   TestGenome(Random *random);
 
    // Destructor.
    ~TestGenome();
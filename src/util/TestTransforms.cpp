@@ -0,0 +1,87 @@
+/*
+ * This software is provided under the terms of the GNU General
+ * Public License as published by the Free Software Foundation.
+ *
+ * Copyright (c) 2003 Tom Portegys, All Rights Reserved.
+ * Permission to use, copy, modify, and distribute this software
+ * and its documentation for NON-COMMERCIAL purposes and without
+ * fee is hereby granted provided that this copyright notice
+ * appears in all copies.
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.
+ */
+
+/*
+ * Test that the orientation and neighborhood transform tables
+ * equal the computed transforms for every orientation and
+ * neighborhood location.
+ * Usage: TestTransforms
+ */
+
+#include <stdio.h>
+#include "../base/Orientation.hpp"
+#include "../base/Cell.hpp"
+
+int main()
+{
+   int          i, x, y, x1, y1, x2, y2, errors;
+   Orientation  orientation;
+   Neighborhood neighbors;
+
+   errors = 0;
+   for (i = 0; i < NUM_ORIENTATIONS; i++)
+   {
+      orientation.direction = i % 8;
+      orientation.mirrored  = (i >= 8);
+      neighbors.transform(orientation);
+      for (x = -1; x <= 1; x++)
+      {
+         for (y = -1; y <= 1; y++)
+         {
+            // Orientation transform.
+            x1 = x2 = x;
+            y1 = y2 = y;
+            orientation.transform(x1, y1);
+            orientation.computeTransform(x2, y2);
+            if ((x1 != x2) || (y1 != y2))
+            {
+               printf("Orientation %d transform of %d,%d: table=%d,%d, computed=%d,%d\n",
+                      i, x, y, x1, y1, x2, y2);
+               errors++;
+            }
+
+            // Neighborhood cell location.
+            x1 = x2 = x;
+            y1 = y2 = y;
+            neighbors.getCellLocation(x1, y1);
+            neighbors.computeCellLocation(x2, y2);
+            if ((x1 != x2) || (y1 != y2))
+            {
+               printf("Orientation %d cell location of %d,%d: table=%d,%d, computed=%d,%d\n",
+                      i, x, y, x1, y1, x2, y2);
+               errors++;
+            }
+
+            // Neighborhood cell offsets.
+            Neighborhood::getDxy(x, y, orientation, x1, y1);
+            Neighborhood::computeDxy(x, y, orientation, x2, y2);
+            if ((x1 != x2) || (y1 != y2))
+            {
+               printf("Orientation %d offsets of %d,%d: table=%d,%d, computed=%d,%d\n",
+                      i, x, y, x1, y1, x2, y2);
+               errors++;
+            }
+         }
+      }
+   }
+   if (errors > 0)
+   {
+      printf("%d transform table errors\n", errors);
+      return(1);
+   }
+   printf("Transform tables OK\n");
+   return(0);
+}
@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# Farm loopback test: evolve one cycle in process, then the same cycle
+# (same seed) farmed out to workers on a local socket, and check that
+# the populations and logs match.
+# Usage: farmtest.sh <test body file name> [<number of workers>]
+# Run from the work directory after making ../bin/Evolve.
+
+EVOLVE=../bin/Evolve
+SEED=12345
+
+if [ $# -lt 1 ]
+then
+   echo "Usage: farmtest.sh <test body file name> [<number of workers>]"
+   exit 1
+fi
+BODIES=$1
+WORKERS=${2:-2}
+DIR=farmtest.$$
+SOCKET=$DIR/farm.sock
+mkdir $DIR || exit 1
+
+# In process.
+$EVOLVE -cycles 1 -seed $SEED -bodies $BODIES \
+   -output $DIR/local.bin -logfile $DIR/local.log > /dev/null || exit 1
+
+# Farmed: coordinator and workers.
+$EVOLVE -cycles 1 -seed $SEED -bodies $BODIES \
+   -output $DIR/farm.bin -logfile $DIR/farm.log -farm $SOCKET > /dev/null &
+COORDINATOR=$!
+sleep 1
+i=0
+while [ $i -lt $WORKERS ]
+do
+   $EVOLVE -worker $SOCKET -logfile $DIR/worker$i.log > /dev/null &
+   i=`expr $i + 1`
+done
+wait $COORDINATOR || exit 1
+wait
+
+# Compare, ignoring output names and farm connection lines.
+STATUS=0
+if ! cmp -s $DIR/local.bin $DIR/farm.bin
+then
+   echo "Populations differ"
+   STATUS=1
+fi
+grep -v "^Initializing\|^Farm\|^Waiting for farm" $DIR/local.log > $DIR/local.txt
+grep -v "^Initializing\|^Farm\|^Waiting for farm" $DIR/farm.log > $DIR/farm.txt
+if ! cmp -s $DIR/local.txt $DIR/farm.txt
+then
+   echo "Logs differ"
+   STATUS=1
+fi
+if [ $STATUS -eq 0 ]
+then
+   echo "Farm test OK"
+   rm -r $DIR
+else
+   echo "Farm test failed, see $DIR"
+fi
+exit $STATUS